@@ -0,0 +1,137 @@
+#include "ConcurrentRunner.hpp"
+
+#include "Device.hpp"
+#include "Driver.hpp"
+#include "IOP.hpp"
+#include "Misc.hpp"
+
+#include <cassert>
+#include <thread>
+
+namespace groq {
+
+ConcurrentRunner::ConcurrentRunner(Driver &driver, const IOP &iop, size_t programIndex, size_t entrypointIndex,
+                                   size_t numContexts)
+    : iop(iop)
+    , programIndex(programIndex)
+    , entrypointIndex(entrypointIndex)
+    , tspInputSize(groq_program_get_input_size(iop.handle(), programIndex))
+    , numContexts(numContexts)
+    , inputLayouts(resolveInputLayouts())
+    , outputLayouts(resolveOutputLayouts())
+    , inputIoba(nullptr)
+    , outputIoba(nullptr)
+    , freeMask(0)
+{
+    if (numContexts == 0 || numContexts > 64) {
+        throw std::runtime_error("Context count must be between 1 and 64");
+    }
+
+    GROQOK(groq_allocate_inputs_iobuffer_array(driver.handle(), iop.handle(), numContexts, &inputIoba));
+    GROQOK(groq_allocate_outputs_iobuffer_array(driver.handle(), iop.handle(), numContexts, &outputIoba));
+
+    assert(inputIoba);
+    assert(outputIoba);
+
+    freeMask.store(numContexts == 64 ? ~uint64_t(0) : (uint64_t(1) << numContexts) - 1, std::memory_order_release);
+}
+
+ConcurrentRunner::~ConcurrentRunner()
+{
+    ::Status status;
+    status = groq_deallocate_iobuffer_array(inputIoba);
+    status = groq_deallocate_iobuffer_array(outputIoba);
+    unused(status);
+}
+
+size_t ConcurrentRunner::acquireContext()
+{
+    uint64_t mask = freeMask.load(std::memory_order_relaxed);
+    for (;;) {
+        while (mask == 0) {
+            std::this_thread::yield();
+            mask = freeMask.load(std::memory_order_relaxed);
+        }
+
+        const size_t context = static_cast<size_t>(__builtin_ctzll(mask));
+        if (freeMask.compare_exchange_weak(mask, mask & ~(uint64_t(1) << context), std::memory_order_acq_rel,
+                                           std::memory_order_relaxed)) {
+            return context;
+        }
+    }
+}
+
+void ConcurrentRunner::releaseContext(size_t context)
+{
+    freeMask.fetch_or(uint64_t(1) << context, std::memory_order_release);
+}
+
+void ConcurrentRunner::invoke(Device &device, const RequestBuffers &request, size_t timeoutMs)
+{
+    if (request.inputs.size() != inputLayouts.size() || request.outputs.size() != outputLayouts.size()) {
+        throw std::runtime_error("Request must bind all " + std::to_string(inputLayouts.size()) + " inputs and "
+                                 + std::to_string(outputLayouts.size()) + " outputs");
+    }
+
+    const size_t context = acquireContext();
+
+    // Once submitted, the context may only go back in the pool after its
+    // completion is observed: a timed-out invocation can still finish later
+    // and scribble over a slot another thread has since checked out, so on
+    // that path the context is deliberately left checked out.
+    bool submitted = false;
+    bool completed = false;
+
+    try {
+        // stage this request's inputs into the checked-out context's slot
+        for (size_t i = 0; i < inputLayouts.size(); ++i) {
+            const auto &layout = inputLayouts.at(i);
+
+            uint8_t *output = nullptr;
+            GROQOK(groq_get_data_handle(inputIoba, context, &output));
+            assert(output);
+
+            layout.fromHost(request.inputs.at(i).buffer, request.inputs.at(i).size, output, tspInputSize);
+        }
+
+        ::Completion completion;
+        GROQOK(groq_invoke(device.handle(), inputIoba, context, outputIoba, context, &completion));
+        submitted = true;
+        GROQOK(groq_wait_for_completion(completion, timeoutMs));
+        completed = true;
+
+        // drain the results into this request's output buffers
+        for (size_t i = 0; i < outputLayouts.size(); ++i) {
+            const auto &layout = outputLayouts.at(i);
+
+            uint8_t *input = nullptr;
+            GROQOK(groq_get_data_handle(outputIoba, context, &input));
+            assert(input);
+
+            layout.toHost(input, layout.getIoSize(), request.outputs.at(i).buffer, request.outputs.at(i).size);
+        }
+    } catch (...) {
+        if (!submitted || completed) {
+            releaseContext(context);
+        }
+        throw;
+    }
+
+    releaseContext(context);
+}
+
+const std::vector<TensorLayout> &ConcurrentRunner::resolveInputLayouts() const
+{
+    const auto &program = iop.getPrograms().at(programIndex);
+    const auto &ep = program.getEntrypoints().at(entrypointIndex);
+    return ep.getInputIODescriptor().getTensorLayouts();
+}
+
+const std::vector<TensorLayout> &ConcurrentRunner::resolveOutputLayouts() const
+{
+    const auto &program = iop.getPrograms().at(programIndex);
+    const auto &ep = program.getEntrypoints().at(entrypointIndex);
+    return ep.getOutputIODescriptor().getTensorLayouts();
+}
+
+} // namespace groq
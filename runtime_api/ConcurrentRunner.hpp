@@ -0,0 +1,66 @@
+#pragma once
+
+#include <groqio.h>
+
+#include "SimpleRunner.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace groq {
+
+class Device;
+class Driver;
+class IOP;
+class TensorLayout;
+
+/**
+ * @brief groq::ConcurrentRunner drives one loaded program from many threads
+ *
+ * SimpleRunner is single-threaded by design: its buffer bindings and ring
+ * cursor are shared state.  ConcurrentRunner instead owns a pool of staging
+ * contexts -- one IOBufferArray slot each -- checked out and returned with a
+ * single atomic bitmask, so invocations from N request-handler threads
+ * stage, execute, and drain fully in parallel with no mutex anywhere on the
+ * call path.  Each invoke call carries its own RequestBuffers, there is no
+ * bind-then-invoke state to race on.
+ *
+ * When every context is busy, invoke spins (yielding) until one is returned;
+ * size the pool to the concurrency you actually want per card.
+ */
+class ConcurrentRunner
+{
+    const IOP &iop;
+    const size_t programIndex;
+    const size_t entrypointIndex;
+    const size_t tspInputSize;
+    const size_t numContexts;
+
+    const std::vector<TensorLayout> &inputLayouts;
+    const std::vector<TensorLayout> &outputLayouts;
+
+    ::IOBufferArray inputIoba;
+    ::IOBufferArray outputIoba;
+
+    // bit i set = context i free
+    std::atomic<uint64_t> freeMask;
+
+    size_t acquireContext();
+    void releaseContext(size_t context);
+
+    const std::vector<TensorLayout> &resolveInputLayouts() const;
+    const std::vector<TensorLayout> &resolveOutputLayouts() const;
+
+public:
+    ConcurrentRunner(Driver &driver, const IOP &iop, size_t programIndex = 0, size_t entrypointIndex = 0,
+                     size_t numContexts = 4);
+    ~ConcurrentRunner();
+
+    ConcurrentRunner(const ConcurrentRunner &) = delete;
+    ConcurrentRunner &operator=(const ConcurrentRunner &) = delete;
+
+    void invoke(Device &device, const RequestBuffers &request, size_t timeoutMs = 30000);
+};
+
+} // namespace groq
@@ -38,16 +38,19 @@ bool Device::isOpen()
 void Device::close()
 {
     GROQOK(::groq_device_close(device));
+    resident.clear();
 }
 
 void Device::clearMemory()
 {
     GROQOK(::groq_device_clear_memory(device));
+    resident.clear();
 }
 
 void Device::reset()
 {
     GROQOK(groq_device_reset(device));
+    resident.clear();
 }
 
 int32_t Device::getNumaNode() const
@@ -57,7 +60,62 @@ int32_t Device::getNumaNode() const
 
 void Device::loadProgram(const IOP &iop, size_t n, bool keepEntryPoints)
 {
+    for (auto it = resident.begin(); it != resident.end(); ++it) {
+        if (it->iop == iop.handle() && it->programIndex == n && it->keepEntryPoints == keepEntryPoints) {
+            // already resident; refresh its LRU position and skip the load
+            ResidentProgram hit = *it;
+            resident.erase(it);
+            resident.push_back(hit);
+            return;
+        }
+    }
+
     GROQOK(groq_load_program(device, iop.handle(), n, keepEntryPoints));
+
+    resident.push_back({ iop.handle(), n, keepEntryPoints });
+    while (resident.size() > residencyCapacity) {
+        resident.erase(resident.begin());
+    }
+}
+
+void Device::prepare(const IOP &iop, size_t n, bool keepEntryPoints, bool forceReset)
+{
+    if (!isOpen()) {
+        open();
+    }
+
+    if (forceReset) {
+        reset();
+        clearMemory();
+    }
+
+    loadProgram(iop, n, keepEntryPoints);
+}
+
+void Device::assumeResident(const IOP &iop, size_t n, bool keepEntryPoints)
+{
+    for (const auto &program : resident) {
+        if (program.iop == iop.handle() && program.programIndex == n && program.keepEntryPoints == keepEntryPoints) {
+            return;
+        }
+    }
+
+    resident.push_back({ iop.handle(), n, keepEntryPoints });
+    while (resident.size() > residencyCapacity) {
+        resident.erase(resident.begin());
+    }
+}
+
+void Device::setResidencyCapacity(size_t capacity)
+{
+    if (capacity == 0) {
+        throw std::runtime_error("Residency capacity must be at least 1");
+    }
+
+    residencyCapacity = capacity;
+    while (resident.size() > residencyCapacity) {
+        resident.erase(resident.begin());
+    }
 }
 
 } // namespace groq
\ No newline at end of file
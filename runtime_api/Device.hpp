@@ -2,6 +2,10 @@
 
 #include <groqio.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 namespace groq {
 
 class IOP;
@@ -16,9 +20,32 @@ class Program;
  */
 class Device
 {
+public:
+    /**
+     * One program known to be resident on the card.  Identity is the ::IOP
+     * handle plus program index: reloading the same in-memory IOP image is
+     * the redundant case worth skipping, and a freshly loaded IOP gets a
+     * fresh handle.
+     */
+    struct ResidentProgram
+    {
+        ::IOP iop;
+        size_t programIndex;
+        bool keepEntryPoints;
+    };
+
+private:
     ::Device device;
     int32_t numaNode{ -1 };
 
+    // Residency tracking in LRU order (most recent at the back); reset,
+    // clearMemory, and close invalidate it.  The capacity bounds how many
+    // loads we assume the chip can hold before older records are dropped and
+    // their programs reloaded on next use.  The cache lives in this wrapper
+    // object: drive each card through one groq::Device, not through copies.
+    std::vector<ResidentProgram> resident;
+    size_t residencyCapacity{ 8 };
+
 public:
     Device(const ::Device device);
     ~Device();
@@ -34,7 +61,29 @@ public:
 
     int32_t getNumaNode() const;
 
+    // No-op when the program is already resident (hot-swapping services
+    // reload the same few programs constantly; a redundant load costs
+    // hundreds of milliseconds of PCIe traffic).
     void loadProgram(const IOP &iop, size_t n, bool keepEntryPoints);
+
+    const std::vector<ResidentProgram> &residentPrograms() const { return resident; }
+    void setResidencyCapacity(size_t capacity);
+
+    /**
+     * Bring the card up for the given program with the cheapest safe
+     * sequence.  With forceReset (the default) this is the familiar cold
+     * start: open, reset, clearMemory, loadProgram.  With forceReset off --
+     * for reattaching to a card whose state is known good, e.g. a service
+     * restart without a driver reload -- the multi-second reset and the
+     * memory clear are skipped and only the (residency-cached) program load
+     * runs.  Pair with assumeResident to skip even that: it records a
+     * program the caller asserts is still on the chip, so the subsequent
+     * loadProgram is a lookup.  groqio exposes no device epoch to verify the
+     * assertion against, so assumeResident is exactly as trustworthy as its
+     * caller.
+     */
+    void prepare(const IOP &iop, size_t n, bool keepEntryPoints, bool forceReset = true);
+    void assumeResident(const IOP &iop, size_t n, bool keepEntryPoints);
 };
 
 } // namespace groq
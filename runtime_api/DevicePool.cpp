@@ -0,0 +1,76 @@
+#include "DevicePool.hpp"
+
+#include "Driver.hpp"
+#include "IOP.hpp"
+#include "Misc.hpp"
+
+#include <cassert>
+
+namespace groq {
+
+DevicePool::Worker::Worker(Driver &driver, const IOP &iop, size_t nth, size_t programIndex, size_t entrypointIndex,
+                           size_t ringDepth)
+    : device(driver.getDevice(nth))
+    , runner(driver, iop, programIndex, entrypointIndex, ringDepth)
+{
+    device.open();
+    device.reset();
+    device.clearMemory();
+    device.loadProgram(iop, programIndex, false);
+}
+
+DevicePool::DevicePool(Driver &driver, const IOP &iop, size_t numDevices, size_t programIndex, size_t entrypointIndex,
+                       size_t ringDepth)
+{
+    if (numDevices == 0) {
+        throw std::runtime_error("Device pool needs at least one device");
+    }
+
+    workers.reserve(numDevices);
+    for (size_t nth = 0; nth < numDevices; ++nth) {
+        workers.push_back(
+            std::make_unique<Worker>(driver, iop, nth, programIndex, entrypointIndex, ringDepth));
+    }
+}
+
+size_t DevicePool::inFlightCount() const
+{
+    size_t n = 0;
+    for (const auto &worker : workers) {
+        n += worker->runner.inFlightCount();
+    }
+    return n;
+}
+
+/**
+ * Submit one request to the least-loaded device that still has a free ring
+ * slot.  If every ring is full the pool throws; the caller should retire an
+ * outstanding InvokeHandle and resubmit.
+ */
+InvokeHandle DevicePool::invokeAsync(const RequestBuffers &request, std::function<void(Status)> callback)
+{
+    Worker *best = nullptr;
+    for (const auto &worker : workers) {
+        if (worker->runner.inFlightCount() == worker->runner.depth()) {
+            continue;
+        }
+        if (!best || worker->runner.inFlightCount() < best->runner.inFlightCount()) {
+            best = worker.get();
+        }
+    }
+
+    if (!best) {
+        throw std::runtime_error("All device rings are full; retire an outstanding invocation first");
+    }
+
+    for (size_t i = 0; i < request.inputs.size(); ++i) {
+        best->runner.addInputBuffer(request.inputs.at(i).buffer, request.inputs.at(i).size, i);
+    }
+    for (size_t i = 0; i < request.outputs.size(); ++i) {
+        best->runner.addOutputBuffer(request.outputs.at(i).buffer, request.outputs.at(i).size, i);
+    }
+
+    return best->runner.invokeAsync(best->device, std::move(callback));
+}
+
+} // namespace groq
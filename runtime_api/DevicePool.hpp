@@ -0,0 +1,51 @@
+#pragma once
+
+#include <groqio.h>
+
+#include "Device.hpp"
+#include "SimpleRunner.hpp"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace groq {
+
+class Driver;
+class IOP;
+
+/**
+ * @brief groq::DevicePool dispatches invocations across every card on a host
+ *
+ * The pool opens the first numDevices devices enumerated by the Driver,
+ * brings each one up the same way matmul_example does (open, reset, clear,
+ * loadProgram), and pairs each with its own SimpleRunner.  invokeAsync picks
+ * the device with the fewest invocations in flight that still has a free ring
+ * slot, so a slow card does not block submissions destined for an idle one.
+ */
+class DevicePool
+{
+    struct Worker
+    {
+        Device device;
+        SimpleRunner runner;
+
+        Worker(Driver &driver, const IOP &iop, size_t nth, size_t programIndex, size_t entrypointIndex,
+               size_t ringDepth);
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+public:
+    DevicePool(Driver &driver, const IOP &iop, size_t numDevices, size_t programIndex = 0, size_t entrypointIndex = 0,
+               size_t ringDepth = 1);
+
+    size_t size() const { return workers.size(); }
+    Device &device(size_t nth) { return workers.at(nth)->device; }
+    SimpleRunner &runner(size_t nth) { return workers.at(nth)->runner; }
+
+    size_t inFlightCount() const;
+    InvokeHandle invokeAsync(const RequestBuffers &request, std::function<void(Status)> callback = nullptr);
+};
+
+} // namespace groq
@@ -1,7 +1,11 @@
 #include "Driver.hpp"
 
 #include "Device.hpp"
+#include "IOP.hpp"
 #include "Misc.hpp"
+#include "StagingPool.hpp"
+
+#include <algorithm>
 
 namespace groq {
 
@@ -35,4 +39,50 @@ Device Driver::getNextDevice()
     return groq::Device(device);
 }
 
+std::vector<Driver::BringUpResult> Driver::openAll(const BringUpOptions &options)
+{
+    std::vector<BringUpResult> results(options.numDevices);
+    if (options.numDevices == 0) {
+        return results;
+    }
+
+    // enumeration is cheap and stays serial; the expensive open/reset/load
+    // runs concurrently below
+    for (size_t nth = 0; nth < options.numDevices; ++nth) {
+        try {
+            results[nth].device.reset(new Device(getDevice(nth)));
+        } catch (...) {
+            results[nth].error = std::current_exception();
+        }
+    }
+
+    const size_t concurrency = std::min(std::max<size_t>(options.maxConcurrency, 1), options.numDevices);
+    StagingPool pool(concurrency);
+
+    pool.parallelFor(options.numDevices, [&](size_t nth) {
+        BringUpResult &result = results.at(nth);
+        if (result.error) {
+            return; // enumeration already failed for this slot
+        }
+
+        try {
+            Device &device = *result.device;
+            if (!device.isOpen()) {
+                device.open();
+            }
+            if (options.forceReset) {
+                device.reset();
+                device.clearMemory();
+            }
+            if (options.iop) {
+                device.loadProgram(*options.iop, options.programIndex, options.keepEntryPoints);
+            }
+        } catch (...) {
+            result.error = std::current_exception();
+        }
+    });
+
+    return results;
+}
+
 } // namespace groq
\ No newline at end of file
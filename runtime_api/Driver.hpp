@@ -2,9 +2,14 @@
 
 #include <groqio.h>
 
+#include <exception>
+#include <memory>
+#include <vector>
+
 namespace groq {
 
 class Device;
+class IOP;
 class Driver
 {
     ::Driver driver;
@@ -16,6 +21,36 @@ public:
     ::Driver handle() const;
     Device getDevice(size_t n);
     Device getNextDevice();
+
+    /**
+     * Options for openAll: how many devices to bring up, the bring-up steps
+     * to run on each (mirroring Device::prepare), and how many cards to
+     * initialize concurrently.  Per-device reset dominates multi-card cold
+     * start when run serially; concurrent bring-up takes it to the time of
+     * the slowest single card.
+     */
+    struct BringUpOptions
+    {
+        size_t numDevices{ 1 };
+        const IOP *iop{ nullptr }; // loaded onto every device when set
+        size_t programIndex{ 0 };
+        bool keepEntryPoints{ false };
+        bool forceReset{ true };
+        size_t maxConcurrency{ 8 };
+    };
+
+    /**
+     * Outcome of one device's bring-up: the device (open and loaded) on
+     * success, or the error that stopped it.  A failed card never aborts the
+     * others.
+     */
+    struct BringUpResult
+    {
+        std::unique_ptr<Device> device;
+        std::exception_ptr error; // null on success
+    };
+
+    std::vector<BringUpResult> openAll(const BringUpOptions &options);
 };
 
 } // namespace groq
@@ -1,30 +1,275 @@
 #include "IOP.hpp"
 #include "Misc.hpp"
+#include "PlanCache.hpp"
 
 #include <groqio.h>
 
+#include <algorithm>
 #include <cstring>
 #include <cassert>
 #include <iostream>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace groq {
 
-TensorLayout::TensorLayout(::TensorLayout layout, std::string_view name, size_t iodSize)
+TensorLayout::TensorLayout(::TensorLayout layout, std::string_view name, size_t iodSize,
+                           std::pmr::memory_resource *arena, PlanCache *planCache)
     : layout(layout)
-    , name(name)
+    , name(name, arena)
     , iodSize(iodSize)
+    , planCache(planCache)
 {
     size_t nDims = 0;
     GROQOK(groq_tensor_layout_get_number_of_dimensions(layout, &nDims));
     GROQOK(groq_tensor_layout_get_size(layout, &size));
     GROQOK(groq_tensor_layout_get_format(layout, &format));
+    if (nDims > kMaxDims) {
+        throw std::runtime_error("Tensor has " + std::to_string(nDims) + " dimensions; at most "
+                                 + std::to_string(kMaxDims) + " supported");
+    }
     for (size_t nth = 0; nth < nDims; ++nth) {
-        uint32_t dimension;
-        GROQOK(groq_tensor_layout_get_nth_dimension(layout, nth, &dimension));
-        dimensions.push_back(dimension);
+        GROQOK(groq_tensor_layout_get_nth_dimension(layout, nth, &dims[nth]));
+    }
+    numDims = static_cast<uint32_t>(nDims);
+}
+
+// Compile (once) and return the transform plan for the given direction, or
+// nullptr when the layout's transform cannot be expressed as a plan and the
+// library call must be used instead.
+const TransformPlan *TensorLayout::compiledPlan(TransformPlan::Direction direction) const
+{
+    if (!layout) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(*planMutex);
+
+    auto &slot = direction == TransformPlan::Direction::FromHost ? fromHostPlan : toHostPlan;
+    if (!slot) {
+        const size_t inputSize = direction == TransformPlan::Direction::FromHost ? getHostSize() : getIoSize();
+        const size_t outputSize = direction == TransformPlan::Direction::FromHost ? getIoSize() : getHostSize();
+
+        const uint64_t key = planCache ? PlanCache::layoutKey(name, static_cast<int>(direction), inputSize,
+                                                              outputSize, format, dims, numDims)
+                                       : 0;
+
+        TransformPlan cached;
+        if (planCache && planCache->lookup(key, cached) && cached.inputBytes() == inputSize
+            && cached.outputBytes() == outputSize && cached.validate(layout, direction)) {
+            // one library comparison instead of the full probe compilation
+            slot = std::make_shared<const TransformPlan>(std::move(cached));
+        } else {
+            slot = std::make_shared<const TransformPlan>(
+                TransformPlan::compile(layout, direction, inputSize, outputSize));
+            if (planCache) {
+                planCache->store(key, *slot);
+            }
+        }
+    }
+
+    return slot->valid() ? slot.get() : nullptr;
+}
+
+void TensorLayout::fromHostStream(const Reader &reader, uint8_t *output, size_t outputSize, size_t chunkSize) const
+{
+    if (outputSize != getIoSize()) {
+        throw std::runtime_error("Output size mismatch; expected " + std::to_string(getIoSize()) + " got "
+                                 + std::to_string(outputSize));
+    }
+    if (chunkSize == 0) {
+        throw std::runtime_error("Chunk size must be at least 1");
+    }
+
+    const TransformPlan *plan = compiledPlan(TransformPlan::Direction::FromHost);
+
+    // Without a plan the transform is opaque and needs the whole tensor;
+    // accumulate and do it in one shot.
+    const size_t bufferSize = plan ? std::min(chunkSize, getHostSize()) : getHostSize();
+    std::vector<uint8_t> buffer(bufferSize);
+
+    size_t position = 0;
+    while (position < getHostSize()) {
+        const size_t want = std::min(bufferSize - (plan ? 0 : position), getHostSize() - position);
+        uint8_t *chunk = plan ? &buffer[0] : &buffer[position];
+
+        // a reader may produce fewer bytes per call than asked; keep pulling
+        size_t got = 0;
+        while (got < want) {
+            const size_t n = reader(chunk + got, want - got);
+            if (n == 0) {
+                throw std::runtime_error("Input stream ended after " + std::to_string(position + got) + " of "
+                                         + std::to_string(getHostSize()) + " bytes");
+            }
+            got += n;
+        }
+
+        if (plan) {
+            plan->executeInputWindow(chunk, position, got, output);
+        }
+        position += got;
+    }
+
+    if (!plan) {
+        fromHost(&buffer[0], getHostSize(), output, outputSize);
+    }
+}
+
+void TensorLayout::toHostStream(uint8_t *input, size_t inputSize, const Writer &writer, size_t chunkSize) const
+{
+    if (inputSize != getIoSize()) {
+        throw std::runtime_error("Input size mismatch; expected " + std::to_string(getIoSize()) + " got "
+                                 + std::to_string(inputSize));
+    }
+    if (chunkSize == 0) {
+        throw std::runtime_error("Chunk size must be at least 1");
+    }
+
+    const TransformPlan *plan = compiledPlan(TransformPlan::Direction::ToHost);
+
+    if (!plan) {
+        std::vector<uint8_t> whole(getHostSize());
+        toHost(input, inputSize, &whole[0], whole.size());
+        for (size_t position = 0; position < whole.size(); position += chunkSize) {
+            writer(&whole[position], std::min(chunkSize, whole.size() - position));
+        }
+        return;
+    }
+
+    std::vector<uint8_t> chunk(std::min(chunkSize, getHostSize()));
+    for (size_t position = 0; position < getHostSize(); position += chunk.size()) {
+        const size_t n = std::min(chunk.size(), getHostSize() - position);
+        plan->executeOutputWindow(input, &chunk[0], position, n);
+        writer(&chunk[0], n);
+    }
+}
+
+namespace {
+
+size_t totalFragmentSize(const BufferFragment *fragments, size_t numFragments)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < numFragments; ++i) {
+        total += fragments[i].size;
+    }
+    return total;
+}
+
+} // namespace
+
+void TensorLayout::fromHostGather(const BufferFragment *fragments, size_t numFragments, uint8_t *output,
+                                  size_t outputSize) const
+{
+    if (totalFragmentSize(fragments, numFragments) != getHostSize()) {
+        throw std::runtime_error("Fragment sizes must sum to " + std::to_string(getHostSize()));
+    }
+    if (outputSize != getIoSize()) {
+        throw std::runtime_error("Output size mismatch; expected " + std::to_string(getIoSize()) + " got "
+                                 + std::to_string(outputSize));
+    }
+
+    if (const TransformPlan *plan = compiledPlan(TransformPlan::Direction::FromHost)) {
+        size_t offset = 0;
+        for (size_t i = 0; i < numFragments; ++i) {
+            plan->executeInputWindow(fragments[i].data, offset, fragments[i].size, output);
+            offset += fragments[i].size;
+        }
+        return;
+    }
+
+    // opaque transform: coalesce once and run it whole
+    std::vector<uint8_t> scratch(getHostSize());
+    size_t offset = 0;
+    for (size_t i = 0; i < numFragments; ++i) {
+        std::memcpy(&scratch[offset], fragments[i].data, fragments[i].size);
+        offset += fragments[i].size;
+    }
+    fromHost(&scratch[0], scratch.size(), output, outputSize);
+}
+
+void TensorLayout::toHostScatter(uint8_t *input, size_t inputSize, const BufferFragment *fragments,
+                                 size_t numFragments) const
+{
+    if (totalFragmentSize(fragments, numFragments) != getHostSize()) {
+        throw std::runtime_error("Fragment sizes must sum to " + std::to_string(getHostSize()));
+    }
+    if (inputSize != getIoSize()) {
+        throw std::runtime_error("Input size mismatch; expected " + std::to_string(getIoSize()) + " got "
+                                 + std::to_string(inputSize));
+    }
+
+    if (const TransformPlan *plan = compiledPlan(TransformPlan::Direction::ToHost)) {
+        size_t offset = 0;
+        for (size_t i = 0; i < numFragments; ++i) {
+            plan->executeOutputWindow(input, fragments[i].data, offset, fragments[i].size);
+            offset += fragments[i].size;
+        }
+        return;
+    }
+
+    std::vector<uint8_t> scratch(getHostSize());
+    toHost(input, inputSize, &scratch[0], scratch.size());
+    size_t offset = 0;
+    for (size_t i = 0; i < numFragments; ++i) {
+        std::memcpy(fragments[i].data, &scratch[offset], fragments[i].size);
+        offset += fragments[i].size;
     }
 }
 
+Status TensorLayout::tryFromHost(uint8_t *input, size_t inputSize, uint8_t *output, size_t outputSize) const noexcept
+{
+    try {
+        if (inputSize == getHostSize() && outputSize == getIoSize()) {
+            if (const TransformPlan *plan = compiledPlan(TransformPlan::Direction::FromHost)) {
+                plan->execute(input, output);
+                return GROQ_SUCCESS;
+            }
+        }
+    } catch (...) {
+        // plan compilation failed; the library call below still decides
+    }
+
+    // size mismatches included: the library reports them as a status
+    return groq_tensor_layout_from_host(layout, input, inputSize, output, outputSize);
+}
+
+Status TensorLayout::tryToHost(uint8_t *input, size_t inputSize, uint8_t *output, size_t outputSize) const noexcept
+{
+    try {
+        if (inputSize == getIoSize() && outputSize == getHostSize()) {
+            if (const TransformPlan *plan = compiledPlan(TransformPlan::Direction::ToHost)) {
+                plan->execute(input, output);
+                return GROQ_SUCCESS;
+            }
+        }
+    } catch (...) {
+        // plan compilation failed; the library call below still decides
+    }
+
+    return groq_tensor_layout_to_host(layout, input, inputSize, output, outputSize);
+}
+
+ptrdiff_t TensorLayout::directIoOffset(TransformPlan::Direction direction) const
+{
+    const TransformPlan *plan = compiledPlan(direction);
+    if (!plan || plan->numCopyRuns() != 1 || !plan->fills().empty()) {
+        return -1;
+    }
+
+    const auto &run = plan->copies().front();
+    if (run.len != getHostSize()) {
+        return -1;
+    }
+
+    if (direction == TransformPlan::Direction::FromHost) {
+        return run.src == 0 ? static_cast<ptrdiff_t>(run.dst) : -1;
+    }
+    return run.dst == 0 ? static_cast<ptrdiff_t>(run.src) : -1;
+}
+
 void TensorLayout::toHost(uint8_t *input, size_t inputSize, uint8_t *output, size_t outputSize) const
 {
     if (inputSize != getIoSize()) {
@@ -33,6 +278,12 @@ void TensorLayout::toHost(uint8_t *input, size_t inputSize, uint8_t *output, siz
     if (outputSize != getHostSize()) {
         throw std::runtime_error("Size mismatch");
     }
+
+    if (const TransformPlan *plan = compiledPlan(TransformPlan::Direction::ToHost)) {
+        plan->execute(input, output);
+        return;
+    }
+
     GROQOK(groq_tensor_layout_to_host(layout, input, inputSize, output, outputSize));
 }
 
@@ -46,10 +297,16 @@ void TensorLayout::fromHost(uint8_t *input, size_t inputSize, uint8_t *output, s
         throw std::runtime_error("Output size mismatch; expected " + std::to_string(getIoSize()) + " got "
                                  + std::to_string(outputSize));
     }
+    if (const TransformPlan *plan = compiledPlan(TransformPlan::Direction::FromHost)) {
+        plan->execute(input, output);
+        return;
+    }
+
     GROQOK(groq_tensor_layout_from_host(layout, input, inputSize, output, outputSize));
 }
 
-IODescriptor::IODescriptor(::IODescriptor iodescriptor, size_t size)
+IODescriptor::IODescriptor(::IODescriptor iodescriptor, size_t size, std::pmr::memory_resource *arena,
+                           PlanCache *planCache)
     : size(size)
 {
     size_t n = 0;
@@ -59,12 +316,24 @@ IODescriptor::IODescriptor(::IODescriptor iodescriptor, size_t size)
         char *name;
         GROQOK(groq_iodescriptor_get_nth_tensor_layout(iodescriptor, nth, &layout));
         GROQOK(groq_tensor_layout_get_name(layout, &name));
-        layouts.emplace_back(layout, name, size);
+        layouts.emplace_back(layout, name, size, arena, planCache);
+    }
+}
+
+const TensorLayout *IODescriptor::findTensorLayout(std::string_view name) const
+{
+    // the table is small and contiguous; a linear scan beats a hash here
+    for (const auto &layout : layouts) {
+        if (layout.getName() == name) {
+            return &layout;
+        }
     }
+    return nullptr;
 }
 
-EntryPoint::EntryPoint(::EntryPoint entrypoint, std::string_view name)
-    : name(name)
+EntryPoint::EntryPoint(::EntryPoint entrypoint, std::string_view name, std::pmr::memory_resource *arena,
+                       PlanCache *planCache)
+    : name(name, arena)
 {
     ::IODescriptor inputIod, outputIod;
     GROQOK(groq_entrypoint_get_input_iodescriptor(entrypoint, &inputIod));
@@ -74,27 +343,45 @@ EntryPoint::EntryPoint(::EntryPoint entrypoint, std::string_view name)
     GROQOK(groq_entrypoint_get_input_size(entrypoint, &inputSize));
     GROQOK(groq_entrypoint_get_output_size(entrypoint, &outputSize));
 
-    input = IODescriptor(inputIod, inputSize);
-    output = IODescriptor(outputIod, outputSize);
+    input = IODescriptor(inputIod, inputSize, arena, planCache);
+    output = IODescriptor(outputIod, outputSize, arena, planCache);
 }
 
-Program::Program(const ::Program program, std::string_view name)
-    : name(name)
+Program::Program(const ::Program program, std::string_view name, std::pmr::memory_resource *arena, const IOP *owner)
+    : program(program)
+    , name(name, arena)
+    , arena(arena)
+    , owner(owner)
 {
-    size_t n = 0;
-    GROQOK(groq_get_number_of_entrypoints(program, &n));
-    for (size_t nth = 0; nth < n; ++nth) {
-        ::EntryPoint entrypoint;
-        char *name;
-        GROQOK(groq_get_nth_entrypoint(program, nth, &entrypoint));
-        GROQOK(groq_entrypoint_get_name(entrypoint, &name));
-        entrypoints.emplace_back(entrypoint, name);
+}
+
+const std::vector<EntryPoint> &Program::getEntrypoints() const
+{
+    std::lock_guard<std::mutex> guard(*lock);
+
+    if (!materialized) {
+        std::vector<EntryPoint> built; // filled aside so a failed walk can be retried cleanly
+        size_t n = 0;
+        GROQOK(groq_get_number_of_entrypoints(program, &n));
+        for (size_t nth = 0; nth < n; ++nth) {
+            ::EntryPoint entrypoint;
+            char *name;
+            GROQOK(groq_get_nth_entrypoint(program, nth, &entrypoint));
+            GROQOK(groq_entrypoint_get_name(entrypoint, &name));
+            built.emplace_back(entrypoint, name, arena, owner ? owner->getPlanCache() : nullptr);
+        }
+        entrypoints = std::move(built);
+        materialized = true;
     }
+
+    return entrypoints;
 }
 
 IOP::IOP(const std::string &filename)
     : data(readFile(filename))
 {
+    bytes = &data[0];
+    numBytes = data.size();
     initialize();
 }
 
@@ -102,27 +389,247 @@ IOP::IOP(const uint8_t *buffer, size_t size)
 {
     data.resize(size);
     std::memcpy(&data[0], buffer, size);
+    bytes = &data[0];
+    numBytes = size;
 
     initialize();
 }
 
+namespace {
+
+// Cheap IOP identity for the plan cache: size + mtime.  Hashing the image
+// content would fault in every page of a multi-GB mapping at startup,
+// defeating MapMode::Shared's zero-read loading.
+uint64_t fileIdentity(const struct stat &st)
+{
+    const uint64_t fields[] = { uint64_t(st.st_size), uint64_t(st.st_mtim.tv_sec), uint64_t(st.st_mtim.tv_nsec) };
+    return PlanCache::hashBytes(reinterpret_cast<const uint8_t *>(fields), sizeof(fields));
+}
+
+} // namespace
+
+IOP::IOP(const std::string &filename, MapMode mode)
+{
+    if (mode == MapMode::Copy) {
+        data = readFile(filename);
+        bytes = &data[0];
+        numBytes = data.size();
+        initialize();
+
+        struct stat st;
+        if (::stat(filename.c_str(), &st) == 0) {
+            attachPlanCache(filename + ".lpc", fileIdentity(st));
+        }
+        return;
+    }
+
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open " + filename);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Invalid IOP file: " + filename);
+    }
+
+    const int prot = mode == MapMode::Shared ? PROT_READ : PROT_READ | PROT_WRITE;
+    const int flags = mode == MapMode::Shared ? MAP_SHARED : MAP_PRIVATE;
+    void *mapping = mmap(nullptr, st.st_size, prot, flags, fd, 0);
+    ::close(fd); // the mapping keeps its own reference
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to map " + filename);
+    }
+
+    bytes = static_cast<uint8_t *>(mapping);
+    numBytes = st.st_size;
+    mapped = true;
+
+    try {
+        initialize();
+        attachPlanCache(filename + ".lpc", fileIdentity(st));
+    } catch (...) {
+        munmap(bytes, numBytes);
+        throw;
+    }
+}
+
+IOP::IOP(uint8_t *buffer, size_t size, Borrowed)
+{
+    bytes = buffer;
+    numBytes = size;
+    initialize();
+}
+
+IOP::IOP(uint8_t *mapping, size_t size, Mapped)
+{
+    bytes = mapping;
+    numBytes = size;
+    mapped = true;
+
+    try {
+        initialize();
+    } catch (...) {
+        munmap(bytes, numBytes);
+        throw;
+    }
+}
+
+void IOP::publishShared(const std::string &name) const
+{
+    const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create shared segment " + name);
+    }
+
+    if (ftruncate(fd, numBytes) != 0) {
+        ::close(fd);
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Failed to size shared segment " + name);
+    }
+
+    void *mapping = mmap(nullptr, numBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Failed to map shared segment " + name);
+    }
+
+    std::memcpy(mapping, bytes, numBytes);
+    munmap(mapping, numBytes);
+}
+
+IOP IOP::fromShared(const std::string &name)
+{
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw std::runtime_error("No such shared segment: " + name);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Invalid shared segment: " + name);
+    }
+
+    void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to map shared segment " + name);
+    }
+
+    return IOP(static_cast<uint8_t *>(mapping), st.st_size, Mapped{});
+}
+
+IOP IOP::fromFile(const std::string &filename, MapMode mode)
+{
+    return IOP(filename, mode);
+}
+
+void IOP::attachPlanCache(const std::string &cachePath, uint64_t identity)
+{
+    planCache = std::make_shared<PlanCache>(cachePath, identity);
+}
+
+void IOP::attachPlanCache(const std::string &cachePath)
+{
+    attachPlanCache(cachePath, PlanCache::hashBytes(bytes, numBytes));
+}
+
+IOP IOP::borrow(uint8_t *buffer, size_t size)
+{
+    return IOP(buffer, size, Borrowed{});
+}
+
 IOP::~IOP()
 {
+    if (planCache) {
+        planCache->save(); // best effort; a lost write just means recompiling next run
+    }
+
     auto status = groq_iop_deinit(iop);
     unused(status);
+
+    if (mapped) {
+        munmap(bytes, numBytes);
+    }
 }
 
 void IOP::initialize()
 {
     unsigned int n = 0; // TODO: size_t
-    GROQOK(groq_iop_init(&data[0], data.size(), &iop));
+    GROQOK(groq_iop_init(bytes, numBytes, &iop));
     GROQOK(groq_iop_get_number_of_programs(iop, &n));
     for (size_t nth = 0; nth < n; ++nth) {
         ::Program program;
         char *name = nullptr;
         GROQOK(groq_get_nth_program(iop, nth, &program));
         GROQOK(groq_program_name(iop, nth, &name));
-        programs.emplace_back(program, name);
+        programs.emplace_back(program, name, &arena, this);
+    }
+
+    for (size_t p = 0; p < programs.size(); ++p) {
+        programsByName.emplace(programs.at(p).getName(), p);
+    }
+}
+
+// Materialize one program's entrypoints and add them to the name index.
+// Callers hold indexLock.
+void IOP::indexProgram(size_t programIndex) const
+{
+    const Program &program = programs.at(programIndex);
+    auto &byEntryPoint = entrypointIndex[program.getName()];
+
+    const auto &entrypoints = program.getEntrypoints();
+    for (size_t e = 0; e < entrypoints.size(); ++e) {
+        const EntryPoint &ep = entrypoints.at(e);
+        EntryPointRef ref;
+        ref.programIndex = programIndex;
+        ref.entrypointIndex = e;
+        ref.program = &program;
+        ref.entrypoint = &ep;
+        ref.inputLayouts = &ep.getInputIODescriptor().getTensorLayouts();
+        ref.outputLayouts = &ep.getOutputIODescriptor().getTensorLayouts();
+        ref.inputSize = ep.getInputIODescriptor().getSize();
+        ref.outputSize = ep.getOutputIODescriptor().getSize();
+        byEntryPoint.emplace(ep.getName(), ref);
+    }
+}
+
+const IOP::EntryPointRef &IOP::findEntryPoint(std::string_view programName, std::string_view entrypointName) const
+{
+    const auto program = programsByName.find(programName);
+    if (program == programsByName.end()) {
+        throw std::runtime_error("No such program: " + std::string(programName));
+    }
+
+    std::lock_guard<std::mutex> guard(indexLock);
+
+    auto byEntryPoint = entrypointIndex.find(programName);
+    if (byEntryPoint == entrypointIndex.end()) {
+        indexProgram(program->second);
+        byEntryPoint = entrypointIndex.find(programName);
+        assert(byEntryPoint != entrypointIndex.end());
+    }
+
+    const auto ep = byEntryPoint->second.find(entrypointName);
+    if (ep == byEntryPoint->second.end()) {
+        throw std::runtime_error("No such entrypoint: " + std::string(programName) + "/"
+                                 + std::string(entrypointName));
+    }
+
+    return ep->second;
+}
+
+void IOP::materializeAll() const
+{
+    std::lock_guard<std::mutex> guard(indexLock);
+
+    for (size_t p = 0; p < programs.size(); ++p) {
+        if (entrypointIndex.find(programs.at(p).getName()) == entrypointIndex.end()) {
+            indexProgram(p);
+        }
     }
 }
 
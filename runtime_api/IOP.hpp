@@ -1,34 +1,121 @@
 #pragma once
 
 #include <groqio.h>
+
+#include "TransformPlan.hpp"
+
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace groq {
 
+class PlanCache;
+
+// One piece of a host tensor that arrives or leaves in fragments (e.g. rope
+// buffers from an RPC layer); fragments are ordered and back-to-back in
+// tensor byte order.
+struct BufferFragment
+{
+    uint8_t *data;
+    size_t size;
+};
+
+// Metadata strings and dimension lists live in the owning IOP's arena (a
+// monotonic buffer resource): thousands of tiny allocations collapse into a
+// few contiguous slabs that are cache-friendly to traverse on the staging
+// path and freed in O(1) when the IOP goes away.  Standalone (default- or
+// copy-constructed) objects fall back to the default resource.
+
 class TensorLayout
 {
+public:
+    static constexpr size_t kMaxDims = 8;
+
+private:
     ::TensorLayout layout{ nullptr };
-    std::string name{};
+    std::pmr::string name{};
     size_t iodSize; // tsp size, not for just this layout -- but for this one and its "neighbors"
     size_t size;    // host size
     int32_t format;
-    std::vector<uint32_t> dimensions;
+
+    // dimensions live inline: the per-entrypoint layout table is then one
+    // contiguous array the staging loop streams through with no heap nodes
+    // to chase
+    uint32_t dims[kMaxDims] = {};
+    uint32_t numDims{ 0 };
+
+    // Transform plans are compiled on first use (compilation itself runs a
+    // handful of library transforms, so doing it at IOP load time would slow
+    // startup for layouts that are never invoked) and memoized.
+    mutable std::shared_ptr<const TransformPlan> fromHostPlan;
+    mutable std::shared_ptr<const TransformPlan> toHostPlan;
+    mutable std::shared_ptr<std::mutex> planMutex{ std::make_shared<std::mutex>() };
+    PlanCache *planCache{ nullptr }; // owned by the IOP; consulted before compiling
+
+    const TransformPlan *compiledPlan(TransformPlan::Direction direction) const;
 
 public:
-    TensorLayout(::TensorLayout layout, std::string_view name, size_t iodSize);
+    TensorLayout(::TensorLayout layout, std::string_view name, size_t iodSize,
+                 std::pmr::memory_resource *arena = std::pmr::get_default_resource(),
+                 PlanCache *planCache = nullptr);
     TensorLayout() = default;
 
-    const std::string &getName() const { return name; }
+    const std::pmr::string &getName() const { return name; }
     enum Format { STRIDED = 0, CONTIGUOUS = 1 };
     Format getFormat() const { return static_cast<Format>(format); }
     size_t getHostSize() const { return size; }
     size_t getIoSize() const { return iodSize; }
-    const std::vector<uint32_t> &getDimensions() const { return dimensions; }
+    const uint32_t *getDimensions() const { return dims; }
+    size_t numDimensions() const { return numDims; }
 
     void toHost(uint8_t *input, size_t inputSize, uint8_t *output, size_t outputSize) const;
     void fromHost(uint8_t *input, size_t inputSize, uint8_t *output, size_t outputSize) const;
+
+    // noexcept variants for hot paths: the library status comes back as a
+    // value instead of a formatted exception, so retry loops under transient
+    // device backpressure do no string building and no unwinding
+    Status tryToHost(uint8_t *input, size_t inputSize, uint8_t *output, size_t outputSize) const noexcept;
+    Status tryFromHost(uint8_t *input, size_t inputSize, uint8_t *output, size_t outputSize) const noexcept;
+
+    // Produces up to maxBytes into buffer and returns how many; 0 means the
+    // source is exhausted.
+    using Reader = std::function<size_t(uint8_t *buffer, size_t maxBytes)>;
+    // Consumes the given bytes (e.g. appends them to a response).
+    using Writer = std::function<void(const uint8_t *buffer, size_t bytes)>;
+
+    /**
+     * Stream the host tensor into the io buffer chunk by chunk, so network
+     * receive, layout transform, and DMA overlap and host memory is capped at
+     * chunkSize instead of the tensor size.  The chunked path needs a
+     * compiled transform plan; layouts without one fall back to accumulating
+     * the whole tensor and calling fromHost (correct, but unchunked).
+     * toHostStream is the matching output drain.
+     */
+    void fromHostStream(const Reader &reader, uint8_t *output, size_t outputSize, size_t chunkSize) const;
+    void toHostStream(uint8_t *input, size_t inputSize, const Writer &writer, size_t chunkSize) const;
+
+    /**
+     * Scatter-gather variants: the host tensor is a list of fragments whose
+     * sizes sum to getHostSize().  With a compiled plan each fragment is
+     * scattered into (or gathered out of) the io buffer directly -- no
+     * coalescing copy; without one the fragments are coalesced into a
+     * scratch buffer and the ordinary transform runs.
+     */
+    void fromHostGather(const BufferFragment *fragments, size_t numFragments, uint8_t *output,
+                        size_t outputSize) const;
+    void toHostScatter(uint8_t *input, size_t inputSize, const BufferFragment *fragments, size_t numFragments) const;
+
+    // If the transform in the given direction is one contiguous copy of the
+    // whole host tensor (true for CONTIGUOUS layouts), returns the tensor's
+    // byte offset inside the io buffer; returns -1 when the tensor cannot be
+    // accessed in place and must go through fromHost/toHost.
+    ptrdiff_t directIoOffset(TransformPlan::Direction direction) const;
 };
 
 class IODescriptor
@@ -38,53 +125,177 @@ class IODescriptor
 
 public:
     IODescriptor() = default;
-    IODescriptor(::IODescriptor iodescriptor, size_t size);
+    IODescriptor(::IODescriptor iodescriptor, size_t size,
+                 std::pmr::memory_resource *arena = std::pmr::get_default_resource(),
+                 PlanCache *planCache = nullptr);
     const std::vector<TensorLayout> &getTensorLayouts() const { return layouts; }
     size_t getSize() const { return size; }
+
+    // allocation-free lookup by tensor name; nullptr when absent
+    const TensorLayout *findTensorLayout(std::string_view name) const;
 };
 
 class EntryPoint
 {
-    std::string name;
+    std::pmr::string name;
     IODescriptor input;
     IODescriptor output;
 
 public:
-    EntryPoint(::EntryPoint entrypoint, std::string_view name);
+    EntryPoint(::EntryPoint entrypoint, std::string_view name,
+               std::pmr::memory_resource *arena = std::pmr::get_default_resource(), PlanCache *planCache = nullptr);
 
-    const std::string &getName() const { return name; }
+    const std::pmr::string &getName() const { return name; }
     const IODescriptor &getInputIODescriptor() const { return input; }
     const IODescriptor &getOutputIODescriptor() const { return output; }
 };
 
+class IOP;
+
 class Program
 {
-    std::vector<EntryPoint> entrypoints;
-    std::string name;
+    ::Program program{ nullptr };
+    std::pmr::string name;
+    std::pmr::memory_resource *arena{ std::pmr::get_default_resource() };
+    const IOP *owner{ nullptr }; // for the plan cache at materialization time
+
+    // Entrypoint metadata is expensive to build (every EntryPoint pulls its
+    // IODescriptors and TensorLayouts through a pile of groq_*_get_* calls),
+    // so it is materialized on first use rather than at IOP load -- a service
+    // that runs 3 of 400 programs should not pay for the other 397.
+    mutable std::vector<EntryPoint> entrypoints;
+    mutable bool materialized{ false };
+    mutable std::shared_ptr<std::mutex> lock{ std::make_shared<std::mutex>() };
 
 public:
-    Program(const ::Program program, std::string_view name);
-    const std::string &getName() const { return name; }
-    const std::vector<EntryPoint> &getEntrypoints() const { return entrypoints; }
-    size_t numEntrypoints() const { return entrypoints.size(); }
+    Program(const ::Program program, std::string_view name,
+            std::pmr::memory_resource *arena = std::pmr::get_default_resource(), const IOP *owner = nullptr);
+    const std::pmr::string &getName() const { return name; }
+    const std::vector<EntryPoint> &getEntrypoints() const;
+    size_t numEntrypoints() const { return getEntrypoints().size(); }
 };
 
 class IOP
 {
     ::IOP iop;
-    std::vector<uint8_t> data;
+
+    // arena backing all metadata names/dimensions; declared before the
+    // program table so it outlives everything allocated from it.  The pool
+    // layer makes allocation thread-safe for concurrent lazy materialization
+    // while the monotonic resource underneath keeps everything in slabs.
+    std::pmr::monotonic_buffer_resource arenaSlabs;
+    std::pmr::synchronized_pool_resource arena{ &arenaSlabs };
+
+    std::shared_ptr<PlanCache> planCache;
+
+    std::vector<uint8_t> data; // backing store in the copying modes only
+    uint8_t *bytes{ nullptr };
+    size_t numBytes{ 0 };
+    bool mapped{ false };
     std::vector<Program> programs;
 
 public:
+    /**
+     * How fromFile gets the IOP bytes into memory.  Multi-GB IOPs should use
+     * Shared: the file is mapped read-only straight out of the page cache, so
+     * loading costs no read+copy, peak RSS stays flat, and every process
+     * mapping the same file shares one set of physical pages.  Private maps
+     * copy-on-write instead, for runtimes that patch the image in place.
+     * Copy reproduces the read-everything behavior of the IOP(filename)
+     * constructor.
+     */
+    enum class MapMode { Shared, Private, Copy };
+
     IOP(const std::string &filename);
     IOP(const uint8_t *buffer, size_t size);
     ~IOP();
 
+    IOP(const IOP &) = delete;
+    IOP &operator=(const IOP &) = delete;
+
+    static IOP fromFile(const std::string &filename, MapMode mode = MapMode::Shared);
+
+    // Borrow the caller's buffer without copying; the buffer must outlive
+    // the IOP.
+    static IOP borrow(uint8_t *buffer, size_t size);
+
+    /**
+     * Multi-process sharing on one host: publishShared copies this IOP's
+     * bytes into a named POSIX shared-memory segment (one physical copy in
+     * the page cache), and fromShared constructs an IOP over a read-only
+     * mapping of that segment without copying, so N serving processes stop
+     * multiplying a multi-GB image by N.  The publisher (or an operator)
+     * removes the segment with shm_unlink when it is no longer needed.
+     */
+    void publishShared(const std::string &name) const;
+    static IOP fromShared(const std::string &name);
+
     ::IOP handle() const { return iop; }
     const std::vector<Program> &getPrograms() const { return programs; }
     size_t numPrograms() const { return programs.size(); }
 
+    /**
+     * Attach a persistent transform-plan cache (see PlanCache).  Layouts
+     * materialized afterwards load their compiled plans from it instead of
+     * re-probing, and plans compiled during this run are written back when
+     * the IOP is destroyed.  fromFile attaches <path>.lpc automatically,
+     * keyed by the file's size+mtime -- identity must stay cheap, or
+     * computing it would fault in the whole mapping and undo the zero-read
+     * loading that MapMode::Shared promises.  The overload without an
+     * identity hashes the IOP bytes (a full read of the image); it exists
+     * for borrowed/shared-memory IOPs that have no file to stat.
+     */
+    void attachPlanCache(const std::string &cachePath, uint64_t identity);
+    void attachPlanCache(const std::string &cachePath);
+    PlanCache *getPlanCache() const { return planCache.get(); }
+
+    /**
+     * Everything request-time dispatch needs about one entrypoint, resolved
+     * once at load: indices for loadProgram/SimpleRunner, and the layout and
+     * size metadata the staging path reads, so per-request lookup by name is
+     * two hashes instead of a linear scan over getPrograms().
+     */
+    struct EntryPointRef
+    {
+        size_t programIndex;
+        size_t entrypointIndex;
+        const Program *program;
+        const EntryPoint *entrypoint;
+        const std::vector<TensorLayout> *inputLayouts;
+        const std::vector<TensorLayout> *outputLayouts;
+        size_t inputSize;
+        size_t outputSize;
+    };
+
+    const EntryPointRef &findEntryPoint(std::string_view programName, std::string_view entrypointName) const;
+
+    // Materialize every program's entrypoint metadata up front (the old eager
+    // behavior), for tools that really do want to walk everything.
+    void materializeAll() const;
+
 private:
+    struct Borrowed
+    {
+    };
+
+    struct Mapped
+    {
+    };
+
+    // program name -> index, built eagerly at load (names are cheap); the
+    // per-program entrypoint maps are filled on first findEntryPoint for that
+    // program, when its metadata materializes.  Keys are views into the
+    // Program/EntryPoint name strings, which are stable once built.
+    std::unordered_map<std::string_view, size_t> programsByName;
+    mutable std::unordered_map<std::string_view, std::unordered_map<std::string_view, EntryPointRef>> entrypointIndex;
+    mutable std::mutex indexLock;
+
+    void indexProgram(size_t programIndex) const;
+
+    IOP(const std::string &filename, MapMode mode);
+    IOP(uint8_t *buffer, size_t size, Borrowed);
+    IOP(uint8_t *mapping, size_t size, Mapped); // takes ownership of the mapping
+
     void initialize();
 };
 
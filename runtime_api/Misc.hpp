@@ -2,10 +2,53 @@
 
 #include <groqio.h>
 
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
+namespace groq {
+
+// Status reported by the try* API surface for failures that originate in the
+// wrapper (bad sizes, unbound buffers) rather than in a groqio call.  Chosen
+// outside the library's enum range so it can never shadow a real status.
+constexpr Status GROQ_WRAPPER_ERROR = static_cast<Status>(-1);
+
+/**
+ * @brief groq::Expected carries a value or the Status that prevented it
+ *
+ * The noexcept counterpart of the throwing APIs: recoverable statuses (e.g.
+ * transient device backpressure) come back as values a retry loop can branch
+ * on, with no exception, no string formatting, and no unwinding on the hot
+ * path.
+ */
+template <typename T>
+class Expected
+{
+    std::optional<T> result;
+    Status failure{ GROQ_SUCCESS };
+
+public:
+    Expected(T &&value)
+        : result(std::move(value))
+    {
+    }
+
+    Expected(Status status)
+        : failure(status)
+    {
+    }
+
+    explicit operator bool() const { return result.has_value(); }
+    Status status() const { return result.has_value() ? GROQ_SUCCESS : failure; }
+
+    T &value() { return *result; }
+    const T &value() const { return *result; }
+};
+
+} // namespace groq
+
 #define unused(x) (void)x;
 #define STRINGIFY(x) #x
 #define GROQOK(x)                                                                                                      \
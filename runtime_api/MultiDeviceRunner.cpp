@@ -0,0 +1,71 @@
+#include "MultiDeviceRunner.hpp"
+
+#include "Device.hpp"
+#include "Driver.hpp"
+#include "IOP.hpp"
+#include "Misc.hpp"
+
+#include <cassert>
+
+namespace groq {
+
+MultiDeviceRunner::MultiDeviceRunner(Driver &driver, const IOP &iop, const std::vector<Shard> &shards,
+                                     size_t entrypointIndex, size_t ringDepth)
+    : shards(shards)
+{
+    if (shards.empty()) {
+        throw std::runtime_error("A multi-device runner needs at least one shard");
+    }
+
+    runners.reserve(shards.size());
+    for (const Shard &shard : shards) {
+        assert(shard.device);
+        runners.push_back(std::make_unique<SimpleRunner>(driver, iop, shard.programIndex, entrypointIndex, ringDepth));
+    }
+}
+
+std::vector<InvokeHandle> MultiDeviceRunner::invokeAsync()
+{
+    std::vector<InvokeHandle> handles;
+    handles.reserve(shards.size());
+
+    try {
+        for (size_t nth = 0; nth < shards.size(); ++nth) {
+            handles.push_back(runners.at(nth)->invokeAsync(*shards.at(nth).device));
+        }
+    } catch (...) {
+        // a shard failed to submit; retire the ones already in flight so
+        // their rings are usable again, then report the submission error
+        for (auto &handle : handles) {
+            try {
+                handle.wait();
+            } catch (...) {
+            }
+        }
+        throw;
+    }
+
+    return handles;
+}
+
+void MultiDeviceRunner::invoke(size_t timeoutMs)
+{
+    std::vector<InvokeHandle> handles = invokeAsync();
+
+    std::exception_ptr firstError;
+    for (auto &handle : handles) {
+        try {
+            handle.wait(timeoutMs);
+        } catch (...) {
+            if (!firstError) {
+                firstError = std::current_exception();
+            }
+        }
+    }
+
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+}
+
+} // namespace groq
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <groqio.h>
+
+#include "SimpleRunner.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace groq {
+
+class Device;
+class Driver;
+class IOP;
+
+/**
+ * @brief groq::MultiDeviceRunner executes a program sharded across cards
+ *
+ * Models sharded over a RealScale group compile to one program per card, with
+ * the inter-card tensors moving over the chip-to-chip links as part of the
+ * programs themselves.  The host's only job is to start every card's
+ * invocation close together and wait for them all -- no per-step barriers and
+ * no bouncing intermediate tensors through host staging buffers.  Each shard
+ * keeps its own SimpleRunner, so per-card host inputs and outputs are bound
+ * through runner(nth) exactly as in the single-card case.
+ */
+class MultiDeviceRunner
+{
+public:
+    struct Shard
+    {
+        Device *device;
+        size_t programIndex;
+    };
+
+private:
+    std::vector<Shard> shards;
+    std::vector<std::unique_ptr<SimpleRunner>> runners;
+
+public:
+    MultiDeviceRunner(Driver &driver, const IOP &iop, const std::vector<Shard> &shards, size_t entrypointIndex = 0,
+                      size_t ringDepth = 1);
+
+    size_t size() const { return shards.size(); }
+    SimpleRunner &runner(size_t nth) { return *runners.at(nth); }
+
+    // Submit every card's invocation, then wait for them all.  If any card
+    // fails, the rest are still waited on before the first error is thrown,
+    // so no shard is left silently in flight.
+    void invoke(size_t timeoutMs = 30000);
+
+    // Submit without waiting; retire the handles in any order.
+    std::vector<InvokeHandle> invokeAsync();
+};
+
+} // namespace groq
@@ -0,0 +1,117 @@
+#include "NumaBuffer.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <fstream>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace groq {
+
+#ifdef __linux__
+
+// MPOL_BIND from <linux/mempolicy.h>; mbind has no glibc wrapper, so the
+// binding goes through syscall(2) directly rather than pulling in libnuma.
+static constexpr int kMpolBind = 2;
+
+NumaBuffer::NumaBuffer(size_t size, int32_t node)
+    : length(size)
+{
+    void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to allocate " + std::to_string(size) + " bytes");
+    }
+
+    if (node >= 0) {
+        if (node >= static_cast<int32_t>(sizeof(unsigned long) * 8)) {
+            munmap(mapping, size);
+            throw std::runtime_error("NUMA node out of range: " + std::to_string(node));
+        }
+        const unsigned long nodemask = 1UL << node;
+        if (syscall(SYS_mbind, mapping, size, kMpolBind, &nodemask, sizeof(nodemask) * 8, 0) != 0) {
+            munmap(mapping, size);
+            throw std::runtime_error("Failed to bind buffer to NUMA node " + std::to_string(node));
+        }
+    }
+
+    ptr = static_cast<uint8_t *>(mapping);
+}
+
+NumaBuffer::~NumaBuffer()
+{
+    if (ptr) {
+        munmap(ptr, length);
+    }
+}
+
+void pinThreadToNumaNode(int32_t node)
+{
+    if (node < 0) {
+        return;
+    }
+
+    std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    if (!cpulist) {
+        throw std::runtime_error("No such NUMA node: " + std::to_string(node));
+    }
+
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+
+    // cpulist is ranges like "0-15,32-47"
+    std::string range;
+    while (std::getline(cpulist, range, ',')) {
+        const auto dash = range.find('-');
+        const int first = std::stoi(range.substr(0, dash));
+        const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+
+    if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+        throw std::runtime_error("Failed to pin thread to NUMA node " + std::to_string(node));
+    }
+}
+
+#else // !__linux__
+
+NumaBuffer::NumaBuffer(size_t size, int32_t node)
+    : ptr(new uint8_t[size])
+    , length(size)
+{
+    (void)node; // no NUMA binding off Linux
+}
+
+NumaBuffer::~NumaBuffer()
+{
+    delete[] ptr;
+}
+
+void pinThreadToNumaNode(int32_t node)
+{
+    (void)node;
+}
+
+#endif
+
+NumaBuffer::NumaBuffer(NumaBuffer &&other) noexcept
+    : ptr(std::exchange(other.ptr, nullptr))
+    , length(std::exchange(other.length, 0))
+{
+}
+
+NumaBuffer &NumaBuffer::operator=(NumaBuffer &&other) noexcept
+{
+    std::swap(ptr, other.ptr);
+    std::swap(length, other.length);
+    return *this;
+}
+
+} // namespace groq
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace groq {
+
+/**
+ * @brief groq::NumaBuffer is a page-aligned host buffer bound to a NUMA node
+ *
+ * On dual-socket hosts, staging buffers that land on the wrong node make every
+ * fromHost/toHost copy (and the DMA behind it) cross the interconnect.  A
+ * NumaBuffer is allocated with mmap and bound to the given node with mbind, so
+ * its pages fault in node-local.  Pass the node from Device::getNumaNode() to
+ * keep staging traffic on the card's socket; a negative node skips the binding
+ * and behaves like an ordinary allocation (e.g. on single-socket hosts).
+ */
+class NumaBuffer
+{
+    uint8_t *ptr{ nullptr };
+    size_t length{ 0 };
+
+public:
+    NumaBuffer() = default;
+    NumaBuffer(size_t size, int32_t node);
+    ~NumaBuffer();
+
+    NumaBuffer(const NumaBuffer &) = delete;
+    NumaBuffer &operator=(const NumaBuffer &) = delete;
+    NumaBuffer(NumaBuffer &&other) noexcept;
+    NumaBuffer &operator=(NumaBuffer &&other) noexcept;
+
+    uint8_t *data() { return ptr; }
+    const uint8_t *data() const { return ptr; }
+    size_t size() const { return length; }
+};
+
+/**
+ * Pin the calling thread to the CPUs of the given NUMA node (as listed in
+ * /sys/devices/system/node/nodeN/cpulist), so the thread that runs the
+ * fromHost/toHost transforms stays on the same socket as the buffers and the
+ * card.  A negative node is a no-op.
+ */
+void pinThreadToNumaNode(int32_t node);
+
+} // namespace groq
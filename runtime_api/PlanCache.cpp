@@ -0,0 +1,177 @@
+#include "PlanCache.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace groq {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x43504c47; // "GLPC"
+constexpr uint32_t kVersion = 1;
+
+template <typename T>
+void put(std::vector<uint8_t> &out, const T &value)
+{
+    const size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(&out[at], &value, sizeof(T));
+}
+
+template <typename T>
+bool get(const std::vector<uint8_t> &in, size_t &at, T &value)
+{
+    if (at + sizeof(T) > in.size()) {
+        return false;
+    }
+    std::memcpy(&value, &in[at], sizeof(T));
+    at += sizeof(T);
+    return true;
+}
+
+} // namespace
+
+uint64_t PlanCache::hashBytes(const uint8_t *bytes, size_t n, uint64_t seed)
+{
+    // FNV-1a
+    uint64_t hash = seed;
+    for (size_t i = 0; i < n; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+uint64_t PlanCache::layoutKey(std::string_view name, int direction, size_t inputSize, size_t outputSize,
+                              int32_t format, const uint32_t *dims, size_t numDims)
+{
+    uint64_t hash = hashBytes(reinterpret_cast<const uint8_t *>(name.data()), name.size());
+    const uint64_t fields[] = { uint64_t(direction), inputSize, outputSize, uint64_t(uint32_t(format)), numDims };
+    hash = hashBytes(reinterpret_cast<const uint8_t *>(fields), sizeof(fields), hash);
+    return hashBytes(reinterpret_cast<const uint8_t *>(dims), numDims * sizeof(uint32_t), hash);
+}
+
+PlanCache::PlanCache(std::string path, uint64_t iopIdentity)
+    : path(std::move(path))
+    , iopIdentity(iopIdentity)
+{
+    load();
+}
+
+void PlanCache::load()
+{
+    std::ifstream in(path, std::ios_base::binary);
+    if (!in) {
+        return; // no cache yet; it gets written at teardown
+    }
+
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    size_t at = 0;
+    uint32_t magic = 0, version = 0;
+    uint64_t hash = 0, count = 0;
+    if (!get(bytes, at, magic) || !get(bytes, at, version) || !get(bytes, at, hash) || !get(bytes, at, count)
+        || magic != kMagic || version != kVersion || hash != iopIdentity) {
+        return; // stale (recompiled IOP) or foreign file; recompile from scratch
+    }
+
+    for (uint64_t n = 0; n < count; ++n) {
+        uint64_t key = 0, inputSize = 0, outputSize = 0, copyCount = 0, fillCount = 0;
+        if (!get(bytes, at, key) || !get(bytes, at, inputSize) || !get(bytes, at, outputSize)
+            || !get(bytes, at, copyCount) || !get(bytes, at, fillCount)) {
+            return; // truncated; keep what parsed so far
+        }
+
+        std::vector<TransformPlan::CopyRun> copies(copyCount);
+        std::vector<TransformPlan::FillRun> fills(fillCount);
+        for (auto &run : copies) {
+            if (!get(bytes, at, run.dst) || !get(bytes, at, run.src) || !get(bytes, at, run.len)) {
+                return;
+            }
+        }
+        for (auto &run : fills) {
+            if (!get(bytes, at, run.dst) || !get(bytes, at, run.len) || !get(bytes, at, run.value)) {
+                return;
+            }
+        }
+
+        TransformPlan plan = TransformPlan::fromRuns(inputSize, outputSize, std::move(copies), std::move(fills));
+        if (plan.valid()) {
+            entries.emplace(key, Entry{ std::move(plan), false });
+        }
+    }
+}
+
+bool PlanCache::lookup(uint64_t key, TransformPlan &out) const
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    const auto entry = entries.find(key);
+    if (entry == entries.end()) {
+        return false;
+    }
+
+    out = entry->second.plan;
+    return true;
+}
+
+void PlanCache::store(uint64_t key, const TransformPlan &plan)
+{
+    if (!plan.valid()) {
+        return; // fallback layouts stay uncached; they recompile (and refuse) cheaply
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (entries.emplace(key, Entry{ plan, true }).second) {
+        dirty = true;
+    }
+}
+
+bool PlanCache::save()
+{
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (!dirty) {
+        return true;
+    }
+
+    std::vector<uint8_t> bytes;
+    put(bytes, kMagic);
+    put(bytes, kVersion);
+    put(bytes, iopIdentity);
+    put(bytes, uint64_t(entries.size()));
+
+    for (const auto &item : entries) {
+        const TransformPlan &plan = item.second.plan;
+        put(bytes, item.first);
+        put(bytes, uint64_t(plan.inputBytes()));
+        put(bytes, uint64_t(plan.outputBytes()));
+        put(bytes, uint64_t(plan.copies().size()));
+        put(bytes, uint64_t(plan.fills().size()));
+        for (const auto &run : plan.copies()) {
+            put(bytes, run.dst);
+            put(bytes, run.src);
+            put(bytes, run.len);
+        }
+        for (const auto &run : plan.fills()) {
+            put(bytes, run.dst);
+            put(bytes, run.len);
+            put(bytes, run.value);
+        }
+    }
+
+    std::ofstream out(path, std::ios_base::binary | std::ios_base::trunc);
+    if (!out) {
+        return false;
+    }
+    out.write(reinterpret_cast<const char *>(&bytes[0]), bytes.size());
+    if (!out) {
+        return false;
+    }
+
+    dirty = false;
+    return true;
+}
+
+} // namespace groq
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "TransformPlan.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace groq {
+
+/**
+ * @brief groq::PlanCache persists compiled transform plans next to the IOP
+ *
+ * Compiling a transform plan pushes several full-size probe vectors through
+ * the library transform -- cheap amortized over a long-running process, but
+ * pure waste when hundreds of pods load the same IOP.  The cache stores every
+ * compiled plan in <iop>.lpc, keyed by a caller-provided identity of the IOP
+ * image (fromFile uses the file's size+mtime, so a recompiled IOP
+ * invalidates the whole cache without faulting in a single page of a
+ * multi-GB mapping) plus a per-layout key of name, direction, sizes, format,
+ * and dimensions.  Subsequent starts load the file and skip the probe
+ * passes; a hit is still re-validated with one library comparison before use.
+ *
+ * IOP::fromFile attaches a cache automatically; plans compiled during the
+ * process are written back on IOP teardown (best effort -- a lost write just
+ * means the next process compiles again).
+ */
+class PlanCache
+{
+    struct Entry
+    {
+        TransformPlan plan;
+        bool dirty; // compiled this run; needs writing back
+    };
+
+    std::string path;
+    uint64_t iopIdentity{ 0 };
+    mutable std::mutex lock;
+    std::unordered_map<uint64_t, Entry> entries;
+    bool dirty{ false };
+
+    void load();
+
+public:
+    PlanCache(std::string path, uint64_t iopIdentity);
+
+    // Key a layout's plan by everything that identifies its transform within
+    // this IOP.
+    static uint64_t layoutKey(std::string_view name, int direction, size_t inputSize, size_t outputSize,
+                              int32_t format, const uint32_t *dims, size_t numDims);
+
+    static uint64_t hashBytes(const uint8_t *bytes, size_t n, uint64_t seed = 0xcbf29ce484222325ull);
+
+    bool lookup(uint64_t key, TransformPlan &out) const;
+    void store(uint64_t key, const TransformPlan &plan);
+
+    // Write dirty entries back to <iop>.lpc; returns false (without
+    // throwing) when the file cannot be written.
+    bool save();
+};
+
+} // namespace groq
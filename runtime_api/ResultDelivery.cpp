@@ -0,0 +1,155 @@
+#include "ResultDelivery.hpp"
+
+#include "Device.hpp"
+#include "IOP.hpp"
+#include "Misc.hpp"
+
+#include <cassert>
+
+namespace groq {
+
+ResultDelivery::ResultDelivery(SimpleRunner &runner, size_t poolSize)
+    : runner(runner)
+{
+    if (poolSize == 0) {
+        throw std::runtime_error("Result pool needs at least one entry");
+    }
+
+    const auto &layouts = runner.getOutputLayouts();
+
+    storage.reserve(poolSize);
+    for (size_t n = 0; n < poolSize; ++n) {
+        auto result = std::make_unique<Result>();
+        result->outputs.reserve(layouts.size());
+        for (const auto &layout : layouts) {
+            result->outputs.emplace_back(layout.getHostSize());
+        }
+        result->next = freeList.load(std::memory_order_relaxed);
+        freeList.store(result.get(), std::memory_order_relaxed);
+        storage.push_back(std::move(result));
+    }
+
+    worker = std::thread([this] { drainWorker(); });
+}
+
+ResultDelivery::~ResultDelivery()
+{
+    {
+        std::lock_guard<std::mutex> guard(pendingLock);
+        stopping = true;
+    }
+    pendingWake.notify_all();
+    worker.join();
+}
+
+ResultDelivery::Result *ResultDelivery::acquire()
+{
+    Result *head = freeList.load(std::memory_order_acquire);
+    while (head) {
+        if (freeList.compare_exchange_weak(head, head->next, std::memory_order_acq_rel,
+                                           std::memory_order_acquire)) {
+            head->next = nullptr;
+            head->status = GROQ_SUCCESS;
+            return head;
+        }
+    }
+    return nullptr;
+}
+
+void ResultDelivery::submit(Device &device)
+{
+    Result *result = acquire();
+    if (!result) {
+        throw std::runtime_error("Result pool exhausted; consume and recycle results faster");
+    }
+
+    for (size_t i = 0; i < result->outputs.size(); ++i) {
+        runner.addOutputBuffer(&result->outputs.at(i)[0], result->outputs.at(i).size(), i);
+    }
+
+    InvokeHandle handle;
+    try {
+        handle = runner.invokeAsync(device);
+    } catch (...) {
+        recycle(result);
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(pendingLock);
+        pending.emplace_back(std::move(handle), result);
+    }
+    pendingWake.notify_all();
+}
+
+void ResultDelivery::drainWorker()
+{
+    for (;;) {
+        std::pair<InvokeHandle, Result *> item;
+        {
+            std::unique_lock<std::mutex> guard(pendingLock);
+            pendingWake.wait(guard, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) {
+                return; // stopping, everything delivered
+            }
+            item = std::move(pending.front());
+            pending.pop_front();
+        }
+
+        // tryWait drains the outputs into the pooled buffers bound at submit
+        // and hands back the real status -- the library's failure/timeout
+        // code, or GROQ_WRAPPER_ERROR when the device finished but the
+        // host-side drain failed -- without throwing on the worker
+        item.second->status = item.first.tryWait();
+
+        // publish in completion order
+        Result *result = item.second;
+        result->next = readyList.load(std::memory_order_relaxed);
+        while (!readyList.compare_exchange_weak(result->next, result, std::memory_order_release,
+                                                std::memory_order_relaxed)) {
+        }
+    }
+}
+
+ResultDelivery::Result *ResultDelivery::tryPop()
+{
+    if (!readyBatch) {
+        // take everything published so far and restore FIFO order
+        Result *grabbed = readyList.exchange(nullptr, std::memory_order_acquire);
+        while (grabbed) {
+            Result *next = grabbed->next;
+            grabbed->next = readyBatch;
+            readyBatch = grabbed;
+            grabbed = next;
+        }
+    }
+
+    Result *result = readyBatch;
+    if (result) {
+        readyBatch = result->next;
+        result->next = nullptr;
+    }
+    return result;
+}
+
+ResultDelivery::Result *ResultDelivery::pop()
+{
+    for (;;) {
+        if (Result *result = tryPop()) {
+            return result;
+        }
+        std::this_thread::yield();
+    }
+}
+
+void ResultDelivery::recycle(Result *result)
+{
+    assert(result);
+
+    result->next = freeList.load(std::memory_order_relaxed);
+    while (!freeList.compare_exchange_weak(result->next, result, std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace groq
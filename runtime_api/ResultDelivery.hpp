@@ -0,0 +1,84 @@
+#pragma once
+
+#include <groqio.h>
+
+#include "SimpleRunner.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace groq {
+
+class Device;
+
+/**
+ * @brief groq::ResultDelivery hands results to consumers as completions fire
+ *
+ * In a pipelined deployment the thread that submits invocations should not be
+ * the thread that blocks on them.  ResultDelivery owns a pool of pre-sized
+ * result objects (one host buffer per output tensor) and a drain worker: each
+ * submit binds a pooled result's buffers and queues the invocation; the
+ * worker waits out completions in submission order, drains outputs into the
+ * pooled buffers, and pushes the result onto a lock-free MPSC queue the
+ * application consumes with pop/tryPop.  Results go back to the pool with
+ * recycle once consumed -- no per-call output allocation anywhere.
+ *
+ * submit must stay on one thread (the runner's contract); pop may be called
+ * from one consumer thread; recycle from anywhere.
+ */
+class ResultDelivery
+{
+public:
+    struct Result
+    {
+        std::vector<std::vector<uint8_t>> outputs; // one per output tensor, pre-sized
+        Status status{ GROQ_SUCCESS };
+        Result *next{ nullptr }; // intrusive link (free list / ready queue)
+    };
+
+private:
+    SimpleRunner &runner;
+    std::vector<std::unique_ptr<Result>> storage;
+
+    std::atomic<Result *> freeList{ nullptr };
+
+    // submissions in flight, in order; handed from the submit thread to the
+    // drain worker
+    std::deque<std::pair<InvokeHandle, Result *>> pending;
+    std::mutex pendingLock;
+    std::condition_variable pendingWake;
+    bool stopping{ false };
+
+    // completed results: producers push onto a lock-free LIFO, the consumer
+    // reverses into FIFO batches locally
+    std::atomic<Result *> readyList{ nullptr };
+    Result *readyBatch{ nullptr };
+
+    std::thread worker;
+
+    void drainWorker();
+    Result *acquire();
+
+public:
+    ResultDelivery(SimpleRunner &runner, size_t poolSize);
+    ~ResultDelivery();
+
+    ResultDelivery(const ResultDelivery &) = delete;
+    ResultDelivery &operator=(const ResultDelivery &) = delete;
+
+    // Bind a pooled result's output buffers and submit; inputs are bound on
+    // the runner beforehand as usual.  Throws when the pool is exhausted
+    // (consume and recycle faster, or grow the pool).
+    void submit(Device &device);
+
+    Result *tryPop();
+    Result *pop(); // blocks (yielding) until a result is ready
+    void recycle(Result *result);
+};
+
+} // namespace groq
@@ -0,0 +1,196 @@
+#include "Session.hpp"
+
+#include "Device.hpp"
+#include "Driver.hpp"
+#include "IOP.hpp"
+#include "Misc.hpp"
+
+#include <cassert>
+#include <utility>
+
+namespace groq {
+
+SessionHandle::SessionHandle(Session &session, ::Completion completion, size_t slot)
+    : session(&session)
+    , completion(completion)
+    , slot(slot)
+{
+}
+
+SessionHandle::SessionHandle(SessionHandle &&other) noexcept
+    : session(std::exchange(other.session, nullptr))
+    , completion(std::exchange(other.completion, nullptr))
+    , slot(other.slot)
+    , finished(std::exchange(other.finished, true))
+{
+}
+
+SessionHandle &SessionHandle::operator=(SessionHandle &&other) noexcept
+{
+    if (this != &other) {
+        session = std::exchange(other.session, nullptr);
+        completion = std::exchange(other.completion, nullptr);
+        slot = other.slot;
+        finished = std::exchange(other.finished, true);
+    }
+    return *this;
+}
+
+void SessionHandle::wait(size_t timeoutMs)
+{
+    if (finished) {
+        return;
+    }
+    if (!session) {
+        throw std::runtime_error("Empty SessionHandle");
+    }
+
+    GROQOK(groq_wait_for_completion(completion, timeoutMs));
+
+    finished = true;
+
+    // the slot goes back to the ring even when the drain fails
+    try {
+        session->drainOutputs(slot);
+    } catch (...) {
+        session->slotBusy.at(slot) = false;
+        assert(session->inFlight > 0);
+        --session->inFlight;
+        throw;
+    }
+
+    session->slotBusy.at(slot) = false;
+    assert(session->inFlight > 0);
+    --session->inFlight;
+}
+
+Session::Session(Driver &driver, const IOP &iop, Device &device, size_t ringDepth)
+    : iop(iop)
+    , device(device)
+    , ringDepth(ringDepth)
+    , slotBusy(ringDepth, false)
+    , inputIoba(nullptr)
+    , outputIoba(nullptr)
+    , slotEntries(ringDepth, SIZE_MAX)
+    , slotOutputs(ringDepth)
+{
+    if (ringDepth == 0) {
+        throw std::runtime_error("Ring depth must be at least 1");
+    }
+
+    GROQOK(groq_allocate_inputs_iobuffer_array(driver.handle(), iop.handle(), ringDepth, &inputIoba));
+    GROQOK(groq_allocate_outputs_iobuffer_array(driver.handle(), iop.handle(), ringDepth, &outputIoba));
+
+    assert(inputIoba);
+    assert(outputIoba);
+}
+
+Session::~Session()
+{
+    ::Status status;
+    status = groq_deallocate_iobuffer_array(inputIoba);
+    status = groq_deallocate_iobuffer_array(outputIoba);
+    unused(status);
+}
+
+size_t Session::prepare(size_t programIndex, size_t entrypointIndex)
+{
+    const uint64_t key = (uint64_t(programIndex) << 32) | uint64_t(entrypointIndex);
+    const auto known = stateIds.find(key);
+    if (known != stateIds.end()) {
+        return known->second;
+    }
+
+    const auto &program = iop.getPrograms().at(programIndex);
+    const auto &ep = program.getEntrypoints().at(entrypointIndex);
+
+    EntryState state;
+    state.programIndex = programIndex;
+    state.tspInputSize = groq_program_get_input_size(iop.handle(), programIndex);
+    state.inputLayouts = &ep.getInputIODescriptor().getTensorLayouts();
+    state.outputLayouts = &ep.getOutputIODescriptor().getTensorLayouts();
+
+    states.push_back(state);
+    stateIds.emplace(key, states.size() - 1);
+    return states.size() - 1;
+}
+
+size_t Session::prepare(std::string_view programName, std::string_view entrypointName)
+{
+    const auto &ref = iop.findEntryPoint(programName, entrypointName);
+    return prepare(ref.programIndex, ref.entrypointIndex);
+}
+
+SessionHandle Session::invokeAsync(size_t entry, const RequestBuffers &request)
+{
+    const EntryState &state = states.at(entry);
+
+    if (inFlight == ringDepth) {
+        throw std::runtime_error("Ring is full; wait on an outstanding SessionHandle before submitting more");
+    }
+    if (slotBusy.at(cursor)) {
+        throw std::runtime_error("Ring slot " + std::to_string(cursor)
+                                 + " is still in flight; retire the SessionHandle that claimed it first");
+    }
+    if (request.inputs.size() != state.inputLayouts->size() || request.outputs.size() != state.outputLayouts->size()) {
+        throw std::runtime_error("Request must bind all " + std::to_string(state.inputLayouts->size())
+                                 + " inputs and " + std::to_string(state.outputLayouts->size()) + " outputs");
+    }
+
+    // a load rewrites on-chip state, so another program's outstanding
+    // invocations must retire before the switch
+    if (inFlight != 0 && state.programIndex != activeProgram) {
+        throw std::runtime_error("Cannot switch programs with invocations in flight; "
+                                 "retire outstanding SessionHandles first");
+    }
+
+    // residency-cached: a no-op whenever this program ran last on the card
+    device.loadProgram(iop, state.programIndex, true);
+    activeProgram = state.programIndex;
+
+    const size_t slot = cursor;
+
+    for (size_t i = 0; i < state.inputLayouts->size(); ++i) {
+        const auto &layout = state.inputLayouts->at(i);
+
+        uint8_t *output = nullptr;
+        GROQOK(groq_get_data_handle(inputIoba, slot, &output));
+        assert(output);
+
+        layout.fromHost(request.inputs.at(i).buffer, request.inputs.at(i).size, output, state.tspInputSize);
+    }
+
+    slotEntries.at(slot) = entry;
+    slotOutputs.at(slot) = request.outputs;
+
+    ::Completion completion;
+    GROQOK(groq_invoke(device.handle(), inputIoba, slot, outputIoba, slot, &completion));
+    cursor = (cursor + 1) % ringDepth;
+    slotBusy.at(slot) = true;
+    ++inFlight;
+
+    return SessionHandle(*this, completion, slot);
+}
+
+void Session::invoke(size_t entry, const RequestBuffers &request, size_t timeoutMs)
+{
+    invokeAsync(entry, request).wait(timeoutMs);
+}
+
+void Session::drainOutputs(size_t slot)
+{
+    const EntryState &state = states.at(slotEntries.at(slot));
+
+    const auto &outputs = slotOutputs.at(slot);
+    for (size_t i = 0; i < state.outputLayouts->size(); ++i) {
+        const auto &layout = state.outputLayouts->at(i);
+
+        uint8_t *input = nullptr;
+        GROQOK(groq_get_data_handle(outputIoba, slot, &input));
+        assert(input);
+
+        layout.toHost(input, layout.getIoSize(), outputs.at(i).buffer, outputs.at(i).size);
+    }
+}
+
+} // namespace groq
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <groqio.h>
+
+#include "SimpleRunner.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+namespace groq {
+
+class Device;
+class Driver;
+class IOP;
+class Session;
+
+/**
+ * @brief groq::SessionHandle retires one in-flight Session invocation
+ */
+class SessionHandle
+{
+    friend class Session;
+
+    Session *session{ nullptr };
+    ::Completion completion{ nullptr };
+    size_t slot{ 0 };
+    bool finished{ false };
+
+    SessionHandle(Session &session, ::Completion completion, size_t slot);
+
+public:
+    SessionHandle() = default;
+
+    // Move-only, and a move disarms its source: the moved-from handle reads
+    // as finished and waiting on it is a no-op.
+    SessionHandle(const SessionHandle &) = delete;
+    SessionHandle &operator=(const SessionHandle &) = delete;
+    SessionHandle(SessionHandle &&other) noexcept;
+    SessionHandle &operator=(SessionHandle &&other) noexcept;
+
+    void wait(size_t timeoutMs = 30000);
+    bool isFinished() const { return finished; }
+};
+
+/**
+ * @brief groq::Session drives several entrypoints of one IOP on one Device
+ *
+ * A SimpleRunner binds to one (program, entrypoint) and owns its own
+ * IOBufferArrays, so an alternating encode/decode loop pays twice the buffer
+ * memory and re-resolves layouts per runner.  A Session shares one ring of
+ * IOBufferArray slots across every entrypoint it uses: prepare() resolves an
+ * entrypoint's staging state (layout tables, sizes, program index) once and
+ * hands back a small id, and each invoke names the id -- switching
+ * entrypoints per call costs a table lookup plus a residency-cached
+ * loadProgram, with no rebinding and no buffer duplication.  Buffers travel
+ * with each call as RequestBuffers.
+ *
+ * Entrypoints of one program may alternate freely while pipelined; switching
+ * to a different program reprograms the chip, so it requires the ring to be
+ * idle and invokeAsync throws otherwise.
+ */
+class Session
+{
+    friend class SessionHandle;
+
+    struct EntryState
+    {
+        size_t programIndex;
+        size_t tspInputSize;
+        const std::vector<TensorLayout> *inputLayouts;
+        const std::vector<TensorLayout> *outputLayouts;
+    };
+
+    const IOP &iop;
+    Device &device;
+    const size_t ringDepth;
+    size_t cursor{ 0 };
+    size_t inFlight{ 0 };
+
+    // per-slot occupancy: handles retire in any order, so the in-flight
+    // count alone cannot prove the slot at the cursor is free
+    std::vector<bool> slotBusy;
+
+    // the program whose invocations are (or were last) on the card; a load
+    // rewrites on-chip state, so switching requires an idle ring
+    size_t activeProgram{ SIZE_MAX };
+
+    ::IOBufferArray inputIoba;
+    ::IOBufferArray outputIoba;
+
+    std::vector<EntryState> states;
+    std::unordered_map<uint64_t, size_t> stateIds; // (program << 32 | entrypoint) -> id
+
+    // captured per slot at submit: which entrypoint ran (by id -- the state
+    // table may grow while invocations are in flight) and where its outputs
+    // go
+    std::vector<size_t> slotEntries;
+    std::vector<std::vector<RequestBuffers::Binding>> slotOutputs;
+
+    void drainOutputs(size_t slot);
+
+public:
+    Session(Driver &driver, const IOP &iop, Device &device, size_t ringDepth = 2);
+    ~Session();
+
+    Session(const Session &) = delete;
+    Session &operator=(const Session &) = delete;
+
+    // Resolve an entrypoint's staging state once; returns the id to pass to
+    // invoke.  Calling prepare again for the same entrypoint returns the
+    // same id.
+    size_t prepare(size_t programIndex, size_t entrypointIndex = 0);
+    size_t prepare(std::string_view programName, std::string_view entrypointName);
+
+    SessionHandle invokeAsync(size_t entry, const RequestBuffers &request);
+    void invoke(size_t entry, const RequestBuffers &request, size_t timeoutMs = 30000);
+};
+
+} // namespace groq
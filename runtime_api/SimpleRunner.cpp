@@ -4,28 +4,199 @@
 #include "Driver.hpp"
 #include "IOP.hpp"
 #include "Misc.hpp"
+#include "StagingPool.hpp"
+#include "Trace.hpp"
 
 #include <cassert>
+#include <chrono>
+#include <utility>
 
 namespace groq {
 
-SimpleRunner::SimpleRunner(Driver &driver, const IOP &iop, size_t programIndex, size_t entrypointIndex)
+InvokeHandle::InvokeHandle(SimpleRunner &runner, ::Completion completion, size_t slot,
+                           std::function<void(Status)> callback)
+    : runner(&runner)
+    , completion(completion)
+    , slot(slot)
+    , callback(std::move(callback))
+{
+}
+
+InvokeHandle::InvokeHandle(InvokeHandle &&other) noexcept
+    : runner(std::exchange(other.runner, nullptr))
+    , completion(std::exchange(other.completion, nullptr))
+    , slot(other.slot)
+    , completed(other.completed)
+    , finished(std::exchange(other.finished, true))
+    , callback(std::move(other.callback))
+{
+}
+
+InvokeHandle &InvokeHandle::operator=(InvokeHandle &&other) noexcept
+{
+    if (this != &other) {
+        runner = std::exchange(other.runner, nullptr);
+        completion = std::exchange(other.completion, nullptr);
+        slot = other.slot;
+        completed = other.completed;
+        finished = std::exchange(other.finished, true);
+        callback = std::move(other.callback);
+    }
+    return *this;
+}
+
+bool InvokeHandle::poll()
+{
+    if (finished) {
+        return true;
+    }
+    if (!runner) {
+        throw std::runtime_error("Empty InvokeHandle");
+    }
+
+    // A zero timeout makes groq_wait_for_completion a non-blocking probe; any
+    // non-success here means "not done yet".  Hard failures are reported by
+    // wait(), which callers should use to retire the invocation.
+    if (!completed) {
+        Status status = groq_wait_for_completion(completion, 0);
+        if (status != GROQ_SUCCESS) {
+            return false;
+        }
+        completed = true;
+        GROQ_TRACE(Completion, runner->programIndex, runner->entrypointIndex, slot);
+    }
+
+    finish(GROQ_SUCCESS);
+    return true;
+}
+
+void InvokeHandle::wait(size_t timeoutMs)
+{
+    waitCompletion(timeoutMs);
+    retire();
+}
+
+void InvokeHandle::waitCompletion(size_t timeoutMs)
+{
+    if (completed || finished) {
+        return;
+    }
+    if (!runner) {
+        throw std::runtime_error("Empty InvokeHandle");
+    }
+
+    GROQOK(groq_wait_for_completion(completion, timeoutMs));
+    completed = true;
+    GROQ_TRACE(Completion, runner->programIndex, runner->entrypointIndex, slot);
+}
+
+Status InvokeHandle::tryWait(size_t timeoutMs) noexcept
+{
+    if (finished) {
+        return GROQ_SUCCESS;
+    }
+    if (!runner) {
+        return GROQ_WRAPPER_ERROR; // empty handle
+    }
+
+    if (!completed) {
+        Status status = groq_wait_for_completion(completion, timeoutMs);
+        if (status != GROQ_SUCCESS) {
+            return status; // still in flight (or failed); caller may retry
+        }
+        completed = true;
+    }
+
+    try {
+        finish(GROQ_SUCCESS);
+    } catch (...) {
+        return GROQ_WRAPPER_ERROR; // device done, host-side drain failed
+    }
+    return GROQ_SUCCESS;
+}
+
+void InvokeHandle::retire()
+{
+    if (finished) {
+        return;
+    }
+    if (!runner) {
+        throw std::runtime_error("Empty InvokeHandle");
+    }
+    if (!completed) {
+        throw std::runtime_error("retire() requires a completed invocation; call waitCompletion first");
+    }
+
+    finish(GROQ_SUCCESS);
+}
+
+void InvokeHandle::finish(Status status)
+{
+    assert(runner);
+
+    finished = true;
+
+    // the slot must go back to the ring even when the drain fails, or the
+    // ring loses a slot for the runner's lifetime
+    try {
+        if (status == GROQ_SUCCESS) {
+            runner->drainOutputs(slot);
+        }
+    } catch (...) {
+        runner->slotBusy.at(slot).store(false, std::memory_order_release);
+        assert(runner->inFlight > 0);
+        --runner->inFlight;
+        throw;
+    }
+
+    runner->slotBusy.at(slot).store(false, std::memory_order_release);
+    assert(runner->inFlight > 0);
+    --runner->inFlight;
+    if (callback) {
+        callback(status);
+    }
+}
+
+SimpleRunner::SimpleRunner(Driver &driver, const IOP &iop, size_t programIndex, size_t entrypointIndex,
+                           size_t ringDepth)
     : iop(iop)
     , programIndex(programIndex)
     , entrypointIndex(entrypointIndex)
     , tspInputSize(groq_program_get_input_size(iop.handle(), programIndex))
     , tspOutputSize(groq_program_get_output_size(iop.handle(), programIndex))
-    , numInputs(inputTensorLayouts().size())
-    , numOutputs(outputTensorLayouts().size())
+    , inputLayouts(inputTensorLayouts())
+    , outputLayouts(outputTensorLayouts())
+    , numInputs(inputLayouts.size())
+    , numOutputs(outputLayouts.size())
+    , ringDepth(ringDepth)
+    , slotBusy(ringDepth)
     , inputIoba(nullptr)
     , outputIoba(nullptr)
     , inputBuffers(numInputs, nullptr)
     , outputBuffers(numOutputs, nullptr)
     , inputSizes(numInputs, 0)
     , outputSizes(numOutputs, 0)
+    , inputFragments(numInputs)
+    , outputFragments(numOutputs)
+    , slotOutputBuffers(ringDepth)
+    , slotOutputSizes(ringDepth)
+    , slotOutputFragments(ringDepth)
+    , inputDirect(numInputs, false)
+    , outputDeferred(numOutputs, false)
+    , inputRegistered(numInputs, false)
+    , inputGeneration(numInputs, 1)
+    , slotStagedGeneration(ringDepth, std::vector<uint64_t>(numInputs, 0))
 {
-    GROQOK(groq_allocate_inputs_iobuffer_array(driver.handle(), iop.handle(), 1, &inputIoba));
-    GROQOK(groq_allocate_outputs_iobuffer_array(driver.handle(), iop.handle(), 1, &outputIoba));
+    if (ringDepth == 0) {
+        throw std::runtime_error("Ring depth must be at least 1");
+    }
+
+    for (auto &busy : slotBusy) {
+        busy.store(false); // std::atomic's default constructor leaves it uninitialized in C++17
+    }
+
+    GROQOK(groq_allocate_inputs_iobuffer_array(driver.handle(), iop.handle(), ringDepth, &inputIoba));
+    GROQOK(groq_allocate_outputs_iobuffer_array(driver.handle(), iop.handle(), ringDepth, &outputIoba));
 
     assert(inputIoba);
     assert(outputIoba);
@@ -41,7 +212,7 @@ SimpleRunner::~SimpleRunner()
 
 void SimpleRunner::addInputBuffer(uint8_t *buffer, size_t size, size_t index)
 {
-    const auto &layout = inputTensorLayouts().at(index);
+    const auto &layout = inputLayouts.at(index);
 
     if (size != layout.getHostSize()) {
         throw std::runtime_error("Bad data size; expected " + std::to_string(layout.getHostSize()) + " got "
@@ -52,11 +223,63 @@ void SimpleRunner::addInputBuffer(uint8_t *buffer, size_t size, size_t index)
 
     inputBuffers.at(index) = buffer;
     inputSizes.at(index) = size;
+    inputFragments.at(index).clear();
+    inputRegistered.at(index) = false;
+    ++inputGeneration.at(index);
+}
+
+void SimpleRunner::addInputFragments(const std::vector<BufferFragment> &fragments, size_t index)
+{
+    const auto &layout = inputLayouts.at(index);
+
+    size_t total = 0;
+    for (const auto &fragment : fragments) {
+        assert(fragment.data);
+        total += fragment.size;
+    }
+    if (total != layout.getHostSize()) {
+        throw std::runtime_error("Fragment sizes sum to " + std::to_string(total) + "; expected "
+                                 + std::to_string(layout.getHostSize()));
+    }
+
+    inputFragments.at(index) = fragments;
+    inputBuffers.at(index) = nullptr;
+    inputRegistered.at(index) = false;
+    ++inputGeneration.at(index);
+}
+
+void SimpleRunner::addOutputFragments(const std::vector<BufferFragment> &fragments, size_t index)
+{
+    const auto &layout = outputLayouts.at(index);
+
+    size_t total = 0;
+    for (const auto &fragment : fragments) {
+        assert(fragment.data);
+        total += fragment.size;
+    }
+    if (total != layout.getHostSize()) {
+        throw std::runtime_error("Fragment sizes sum to " + std::to_string(total) + "; expected "
+                                 + std::to_string(layout.getHostSize()));
+    }
+
+    outputFragments.at(index) = fragments;
+    outputBuffers.at(index) = nullptr;
+}
+
+void SimpleRunner::registerInputBuffer(uint8_t *buffer, size_t size, size_t index)
+{
+    addInputBuffer(buffer, size, index);
+    inputRegistered.at(index) = true;
+}
+
+void SimpleRunner::markInputDirty(size_t index)
+{
+    ++inputGeneration.at(index);
 }
 
 void SimpleRunner::addOutputBuffer(uint8_t *buffer, size_t size, size_t index)
 {
-    const auto &layout = outputTensorLayouts().at(index);
+    const auto &layout = outputLayouts.at(index);
 
     if (size != layout.getHostSize()) {
         throw std::runtime_error("Bad data size; expected " + std::to_string(layout.getHostSize()) + " got "
@@ -67,53 +290,397 @@ void SimpleRunner::addOutputBuffer(uint8_t *buffer, size_t size, size_t index)
 
     outputBuffers.at(index) = buffer;
     outputSizes.at(index) = size;
+    outputFragments.at(index).clear();
+}
+
+SimpleRunner::View SimpleRunner::inputView(size_t index)
+{
+    const auto &layout = inputLayouts.at(index);
+
+    // same guard as the submit path: the next slot in rotation must have
+    // retired, or the view would scribble over an in-flight invocation
+    if (slotBusy.at(cursor).load(std::memory_order_acquire)) {
+        throw std::runtime_error("Ring slot " + std::to_string(cursor)
+                                 + " is still in flight; retire the InvokeHandle that claimed it first");
+    }
+
+    const ptrdiff_t offset = layout.directIoOffset(TransformPlan::Direction::FromHost);
+    if (offset < 0) {
+        throw std::runtime_error("Tensor " + std::to_string(index) + " is not contiguous; use addInputBuffer");
+    }
+
+    uint8_t *base = nullptr;
+    GROQOK(groq_get_data_handle(inputIoba, cursor, &base));
+    assert(base);
+
+    inputDirect.at(index) = true;
+    inputBuffers.at(index) = nullptr;
+    inputFragments.at(index).clear();
+
+    return View{ base + offset, layout.getHostSize() };
+}
+
+SimpleRunner::View SimpleRunner::outputView(size_t index, const InvokeHandle &handle)
+{
+    if (handle.runner != this || !handle.finished) {
+        throw std::runtime_error("Output views require a retired InvokeHandle from this runner");
+    }
+
+    const auto &layout = outputLayouts.at(index);
+
+    const ptrdiff_t offset = layout.directIoOffset(TransformPlan::Direction::ToHost);
+    if (offset < 0) {
+        throw std::runtime_error("Tensor " + std::to_string(index) + " is not contiguous; use addOutputBuffer");
+    }
+
+    uint8_t *base = nullptr;
+    GROQOK(groq_get_data_handle(outputIoba, handle.slot, &base));
+    assert(base);
+
+    return View{ base + offset, layout.getHostSize() };
+}
+
+void SimpleRunner::stageInputStream(size_t index, const TensorLayout::Reader &reader, size_t chunkSize)
+{
+    const auto &layout = inputLayouts.at(index);
+
+    // same guard as the submit path: streaming into a slot the device is
+    // still using would corrupt that invocation silently
+    if (slotBusy.at(cursor).load(std::memory_order_acquire)) {
+        throw std::runtime_error("Ring slot " + std::to_string(cursor)
+                                 + " is still in flight; retire the InvokeHandle that claimed it first");
+    }
+
+    uint8_t *base = nullptr;
+    GROQOK(groq_get_data_handle(inputIoba, cursor, &base));
+    assert(base);
+
+    layout.fromHostStream(reader, base, layout.getIoSize(), chunkSize);
+
+    inputDirect.at(index) = true;
+    inputBuffers.at(index) = nullptr;
+}
+
+void SimpleRunner::deferOutput(size_t index, bool deferred)
+{
+    outputDeferred.at(index) = deferred;
+}
+
+void SimpleRunner::drainDeferredOutput(size_t index, const InvokeHandle &handle)
+{
+    if (handle.runner != this || !handle.finished) {
+        throw std::runtime_error("Deferred drain requires a retired InvokeHandle from this runner");
+    }
+
+    const auto &layout = outputLayouts.at(index);
+
+    uint8_t *output = slotOutputBuffers.at(handle.slot).at(index);
+    if (!output) {
+        throw std::runtime_error("Output " + std::to_string(index)
+                                 + " has no bound buffer; use drainOutputStream or outputView");
+    }
+
+    uint8_t *input = nullptr;
+    GROQOK(groq_get_data_handle(outputIoba, handle.slot, &input));
+    assert(input);
+
+    layout.toHost(input, layout.getIoSize(), output, slotOutputSizes.at(handle.slot).at(index));
+}
+
+void SimpleRunner::drainOutputStream(size_t index, const TensorLayout::Writer &writer, const InvokeHandle &handle,
+                                     size_t chunkSize)
+{
+    if (handle.runner != this || !handle.finished) {
+        throw std::runtime_error("Streaming drain requires a retired InvokeHandle from this runner");
+    }
+
+    const auto &layout = outputLayouts.at(index);
+
+    uint8_t *base = nullptr;
+    GROQOK(groq_get_data_handle(outputIoba, handle.slot, &base));
+    assert(base);
+
+    layout.toHostStream(base, layout.getIoSize(), writer, chunkSize);
+}
+
+NumaBuffer SimpleRunner::allocateInputBuffer(size_t index, const Device &device)
+{
+    const auto &layout = inputLayouts.at(index);
+    NumaBuffer buffer(layout.getHostSize(), device.getNumaNode());
+    addInputBuffer(buffer.data(), buffer.size(), index);
+    return buffer;
+}
+
+NumaBuffer SimpleRunner::allocateOutputBuffer(size_t index, const Device &device)
+{
+    const auto &layout = outputLayouts.at(index);
+    NumaBuffer buffer(layout.getHostSize(), device.getNumaNode());
+    addOutputBuffer(buffer.data(), buffer.size(), index);
+    return buffer;
 }
 
 void SimpleRunner::invoke(Device &device)
+{
+    invokeAsync(device).wait();
+}
+
+InvokeHandle SimpleRunner::invokeAsync(Device &device, std::function<void(Status)> callback)
 {
     assert(inputIoba);
     assert(outputIoba);
 
-    // transform user's input data into layout expected by TSP
-    for (size_t i = 0; i < numInputs; ++i) {
-        const auto &layout = inputTensorLayouts().at(i);
+    if (inFlight == ringDepth) {
+        throw std::runtime_error("Ring is full; wait on an outstanding InvokeHandle before submitting more");
+    }
+
+    const size_t slot = cursor;
+    if (slotBusy.at(slot).load(std::memory_order_acquire)) {
+        throw std::runtime_error("Ring slot " + std::to_string(slot)
+                                 + " is still in flight; retire the InvokeHandle that claimed it first");
+    }
+
+    const auto stageStart = std::chrono::steady_clock::now();
+    GROQ_TRACE(StageBegin, programIndex, entrypointIndex, slot);
+    stageInputs(slot);
+    captureOutputs(slot);
+    GROQ_TRACE(StageEnd, programIndex, entrypointIndex, slot);
+    const auto submitStart = std::chrono::steady_clock::now();
+
+    ::Completion completion;
+    GROQOK(groq_invoke(device.handle(), inputIoba, slot, outputIoba, slot, &completion));
+    GROQ_TRACE(Submit, programIndex, entrypointIndex, slot);
+    cursor = (cursor + 1) % ringDepth;
+    slotBusy.at(slot).store(true, std::memory_order_release);
+    ++inFlight;
+
+    const auto submitEnd = std::chrono::steady_clock::now();
+    stageNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(submitStart - stageStart).count();
+    submitNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(submitEnd - submitStart).count();
+
+    return InvokeHandle(*this, completion, slot, std::move(callback));
+}
+
+Expected<InvokeHandle> SimpleRunner::tryInvokeAsync(Device &device) noexcept
+{
+    if (inFlight == ringDepth) {
+        return GROQ_WRAPPER_ERROR; // ring full; retire an outstanding handle first
+    }
+
+    const size_t slot = cursor;
+    if (slotBusy.at(slot).load(std::memory_order_acquire)) {
+        return GROQ_WRAPPER_ERROR; // next slot still in flight; retire its handle first
+    }
+
+    try {
+        stageInputs(slot);
+        captureOutputs(slot);
+    } catch (...) {
+        return GROQ_WRAPPER_ERROR;
+    }
+
+    ::Completion completion;
+    Status status = groq_invoke(device.handle(), inputIoba, slot, outputIoba, slot, &completion);
+    if (status != GROQ_SUCCESS) {
+        return status; // e.g. transient backpressure; the staged slot is reused on retry
+    }
+
+    cursor = (cursor + 1) % ringDepth;
+    slotBusy.at(slot).store(true, std::memory_order_release);
+    ++inFlight;
+
+    return InvokeHandle(*this, completion, slot, nullptr);
+}
+
+Status SimpleRunner::tryInvoke(Device &device, size_t timeoutMs) noexcept
+{
+    Expected<InvokeHandle> handle = tryInvokeAsync(device);
+    if (!handle) {
+        return handle.status();
+    }
+    return handle.value().tryWait(timeoutMs);
+}
+
+InvokeHandle SimpleRunner::invokeAsync(SubmissionQueue &queue, SubmissionQueue::Priority priority,
+                                       SubmissionQueue::Deadline deadline, std::function<void(Status)> callback)
+{
+    InvokeHandle handle;
+    queue.run([&] { handle = invokeAsync(queue.device(), std::move(callback)); }, priority, deadline);
+    return handle;
+}
+
+void SimpleRunner::invoke(SubmissionQueue &queue, SubmissionQueue::Priority priority,
+                          SubmissionQueue::Deadline deadline)
+{
+    invokeAsync(queue, priority, deadline).wait();
+}
+
+/**
+ * Submit a batch of requests in one go to amortize the per-call driver
+ * overhead.  All inputs are staged up front, one groq_invoke is issued per
+ * ring slot, and the completions are waited on together at the end.  The
+ * device retires invocations in submission order, so only the first wait can
+ * block for long -- but every ::Completion still receives its one wait, the
+ * contract the rest of the wrapper follows, so no driver-side completion
+ * state is left unreleased.  The batch may not exceed ringDepth and may not
+ * overlap async invocations.
+ */
+void SimpleRunner::invokeBatch(Device &device, const std::vector<RequestBuffers> &requests, size_t timeoutMs)
+{
+    if (requests.size() > ringDepth) {
+        throw std::runtime_error("Batch of " + std::to_string(requests.size()) + " exceeds ring depth "
+                                 + std::to_string(ringDepth));
+    }
+    if (inFlight != 0) {
+        throw std::runtime_error("Batch submission requires an idle ring");
+    }
+    if (requests.empty()) {
+        return;
+    }
+
+    for (const auto &request : requests) {
+        if (request.inputs.size() != numInputs || request.outputs.size() != numOutputs) {
+            throw std::runtime_error("Each batch request must bind all " + std::to_string(numInputs) + " inputs and "
+                                     + std::to_string(numOutputs) + " outputs");
+        }
+    }
+
+    // stage every request's inputs into its own ring slot
+    for (size_t slot = 0; slot < requests.size(); ++slot) {
+        const auto &request = requests.at(slot);
+        for (size_t i = 0; i < request.inputs.size(); ++i) {
+            addInputBuffer(request.inputs.at(i).buffer, request.inputs.at(i).size, i);
+        }
+        stageInputs(slot);
+    }
+
+    // submit them back to back, then wait each completion once in order;
+    // by the time the first wait returns the later invocations are already
+    // retired or close to it, so the extra waits cost next to nothing
+    std::vector<::Completion> completions(requests.size(), nullptr);
+    for (size_t slot = 0; slot < requests.size(); ++slot) {
+        GROQOK(groq_invoke(device.handle(), inputIoba, slot, outputIoba, slot, &completions[slot]));
+    }
+
+    for (size_t slot = 0; slot < requests.size(); ++slot) {
+        GROQOK(groq_wait_for_completion(completions[slot], timeoutMs));
+    }
+
+    // drain every request's outputs from its slot
+    for (size_t slot = 0; slot < requests.size(); ++slot) {
+        const auto &request = requests.at(slot);
+        for (size_t i = 0; i < request.outputs.size(); ++i) {
+            addOutputBuffer(request.outputs.at(i).buffer, request.outputs.at(i).size, i);
+        }
+        captureOutputs(slot);
+        drainOutputs(slot);
+    }
+}
+
+// transform user's input data into layout expected by TSP; each tensor
+// writes a disjoint region of the slot's IOBuffer, so with a staging pool
+// attached the transforms run in parallel
+void SimpleRunner::stageInputs(size_t slot)
+{
+    const auto stageOne = [&](size_t i) {
+        const auto &layout = inputLayouts.at(i);
 
         uint8_t *input = inputBuffers.at(i);
         uint8_t *output = nullptr;
         size_t inputSize = inputSizes.at(i);
         size_t outputSize = tspInputSize;
 
-        GROQOK(groq_get_data_handle(inputIoba, 0, &output));
+        if (!inputFragments.at(i).empty()) {
+            GROQOK(groq_get_data_handle(inputIoba, slot, &output));
+            assert(output);
+            layout.fromHostGather(inputFragments.at(i).data(), inputFragments.at(i).size(), output, outputSize);
+            return;
+        }
+
+        if (!input) {
+            if (inputDirect.at(i)) {
+                return; // written in place through inputView
+            }
+            throw std::runtime_error("Input " + std::to_string(i) + " is not bound");
+        }
+
+        if (inputRegistered.at(i) && slotStagedGeneration.at(slot).at(i) == inputGeneration.at(i)) {
+            return; // this slot already holds the registered buffer's current contents
+        }
+
+        GROQOK(groq_get_data_handle(inputIoba, slot, &output));
 
-        assert(input);
         assert(output);
 
         layout.fromHost(input, inputSize, output, outputSize);
+        slotStagedGeneration.at(slot).at(i) = inputGeneration.at(i);
+    };
+
+    if (stagingPool && numInputs > 1) {
+        stagingPool->parallelFor(numInputs, stageOne);
+        return;
     }
 
-    ::Completion completion;
-    size_t nthInput = 0;
-    size_t nthOutput = 0;
+    for (size_t i = 0; i < numInputs; ++i) {
+        stageOne(i);
+    }
+}
+
+// remember where this slot's outputs should land once its invocation retires
+void SimpleRunner::captureOutputs(size_t slot)
+{
+    slotOutputBuffers.at(slot) = outputBuffers;
+    slotOutputSizes.at(slot) = outputSizes;
+    slotOutputFragments.at(slot) = outputFragments;
+}
 
-    GROQOK(groq_invoke(device.handle(), inputIoba, nthInput, outputIoba, nthOutput, &completion));
-    GROQOK(groq_wait_for_completion(completion, 30000));
+// transform TSP's output data into layout expected by user
+void SimpleRunner::drainOutputs(size_t slot)
+{
+    GROQ_TRACE(DrainBegin, programIndex, entrypointIndex, slot);
 
-    // transform TSP's output data into layout expected by user
-    for (size_t i = 0; i < numOutputs; ++i) {
-        const auto &layout = outputTensorLayouts().at(i);
+    const auto drainOne = [&](size_t i) {
+        const auto &layout = outputLayouts.at(i);
 
         uint8_t *input = nullptr;
-        uint8_t *output = outputBuffers.at(i);
+        uint8_t *output = slotOutputBuffers.at(slot).at(i);
         size_t inputSize = layout.getIoSize();
-        size_t outputSize = outputSizes.at(i);
+        size_t outputSize = slotOutputSizes.at(slot).at(i);
 
-        GROQOK(groq_get_data_handle(outputIoba, 0, &input));
+        if (outputDeferred.at(i)) {
+            return; // pulled later via drainOutputStream or outputView
+        }
+
+        const auto &fragments = slotOutputFragments.at(slot).at(i);
+        if (!fragments.empty()) {
+            GROQOK(groq_get_data_handle(outputIoba, slot, &input));
+            assert(input);
+            layout.toHostScatter(input, inputSize, fragments.data(), fragments.size());
+            return;
+        }
+
+        if (!output) {
+            if (layout.directIoOffset(TransformPlan::Direction::ToHost) >= 0) {
+                return; // read in place through outputView
+            }
+            throw std::runtime_error("Output " + std::to_string(i) + " is not bound");
+        }
+
+        GROQOK(groq_get_data_handle(outputIoba, slot, &input));
 
         assert(input);
-        assert(output);
 
         layout.toHost(input, inputSize, output, outputSize);
+    };
+
+    if (stagingPool && numOutputs > 1) {
+        stagingPool->parallelFor(numOutputs, drainOne);
+    } else {
+        for (size_t i = 0; i < numOutputs; ++i) {
+            drainOne(i);
+        }
     }
+
+    GROQ_TRACE(DrainEnd, programIndex, entrypointIndex, slot);
 }
 
 const std::vector<TensorLayout> &SimpleRunner::inputTensorLayouts() const
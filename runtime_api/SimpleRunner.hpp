@@ -2,24 +2,132 @@
 
 #include <groqio.h>
 
+#include "IOP.hpp"
+#include "Misc.hpp"
+#include "NumaBuffer.hpp"
+#include "SubmissionQueue.hpp"
+
+#include <atomic>
+#include <functional>
 #include <vector>
 
 namespace groq {
 
 class Device;
 class Driver;
-class IOP;
-class TensorLayout;
+class SimpleRunner;
+class StagingPool;
+
+/**
+ * @brief groq::InvokeHandle is a completion token for SimpleRunner::invokeAsync
+ *
+ * The handle wraps the ::Completion returned by groq_invoke so a single host
+ * thread can keep several invocations in flight and collect them later.  Call
+ * poll() to test for completion without blocking, or wait() to block until the
+ * device is done.  Whichever of the two observes completion first drains the
+ * output buffers and runs the user's callback (if one was given).
+ */
+class InvokeHandle
+{
+    friend class SimpleRunner;
+
+    SimpleRunner *runner{ nullptr };
+    ::Completion completion{ nullptr };
+    size_t slot{ 0 };
+    bool completed{ false };
+    bool finished{ false };
+    std::function<void(Status)> callback;
+
+    InvokeHandle(SimpleRunner &runner, ::Completion completion, size_t slot, std::function<void(Status)> callback);
+
+    void finish(Status status);
+
+public:
+    InvokeHandle() = default;
+
+    // Move-only: exactly one handle may retire a given ::Completion, so a
+    // move disarms its source (the moved-from handle reads as finished and
+    // every operation on it is a no-op).
+    InvokeHandle(const InvokeHandle &) = delete;
+    InvokeHandle &operator=(const InvokeHandle &) = delete;
+    InvokeHandle(InvokeHandle &&other) noexcept;
+    InvokeHandle &operator=(InvokeHandle &&other) noexcept;
+
+    bool poll();
+    void wait(size_t timeoutMs = 30000);
+    bool isFinished() const { return finished; }
+
+    // wait() split into its halves, for callers (benchmarks, pipelines) that
+    // need to observe the device completion separately from the output drain
+    void waitCompletion(size_t timeoutMs = 30000);
+    void retire();
 
+    // noexcept wait: the completion status (e.g. a timeout under
+    // backpressure) comes back as a value; GROQ_WRAPPER_ERROR means the
+    // device finished but the host-side drain failed
+    Status tryWait(size_t timeoutMs = 30000) noexcept;
+};
+
+/**
+ * @brief groq::RequestBuffers names the host buffers of one request in a batch
+ *
+ * Bindings appear in tensor-index order and follow the same size rules as
+ * SimpleRunner::addInputBuffer / addOutputBuffer.
+ */
+struct RequestBuffers
+{
+    struct Binding
+    {
+        uint8_t *buffer;
+        size_t size;
+    };
+
+    std::vector<Binding> inputs;
+    std::vector<Binding> outputs;
+};
+
+/**
+ * @brief groq::SimpleRunner stages host tensors, invokes a program, and drains results
+ *
+ * The runner owns a ring of ringDepth slots in its input and output
+ * IOBufferArrays.  Each invokeAsync call claims the next slot, so with a depth
+ * of 3-4 the host can stage inputs for request k+1 while the device executes
+ * request k and the outputs of request k-1 drain.  A depth of 1 (the default)
+ * reproduces the original strictly-serialized behavior.  At most ringDepth
+ * invocations may be in flight at once, and a submission also requires that
+ * the next slot in rotation has been retired; invokeAsync throws when either
+ * is violated, so handles retired out of order can never alias a slot that
+ * is still in flight.
+ */
 class SimpleRunner
 {
+    friend class InvokeHandle;
+
     const IOP &iop;
     const size_t programIndex;
     const size_t entrypointIndex;
     const size_t tspInputSize;
     const size_t tspOutputSize;
+
+    // resolved once at construction; the staging loops run on every invoke
+    // and must not re-chase program -> entrypoint -> iodescriptor each call
+    const std::vector<TensorLayout> &inputLayouts;
+    const std::vector<TensorLayout> &outputLayouts;
+
     const size_t numInputs;
     const size_t numOutputs;
+    const size_t ringDepth;
+    size_t cursor{ 0 };
+
+    // atomic so one thread may submit while another retires handles (the
+    // ResultDelivery pattern); all other runner state keeps the
+    // one-submitter contract
+    std::atomic<size_t> inFlight{ 0 };
+
+    // per-slot occupancy: handles may be retired in any order, so the
+    // in-flight count alone cannot prove that the slot at the cursor is
+    // free.  Set at submit, cleared after the slot's outputs drain.
+    std::vector<std::atomic<bool>> slotBusy;
 
     ::IOBufferArray inputIoba;
     ::IOBufferArray outputIoba;
@@ -28,15 +136,145 @@ class SimpleRunner
     std::vector<size_t> inputSizes;
     std::vector<size_t> outputSizes;
 
+    // fragment bindings (empty = contiguous binding in use)
+    std::vector<std::vector<BufferFragment>> inputFragments;
+    std::vector<std::vector<BufferFragment>> outputFragments;
+
+    // output bindings captured per ring slot at submit time, so rebinding
+    // between submissions cannot redirect an in-flight invocation's drain
+    std::vector<std::vector<uint8_t *>> slotOutputBuffers;
+    std::vector<std::vector<size_t>> slotOutputSizes;
+    std::vector<std::vector<std::vector<BufferFragment>>> slotOutputFragments;
+
+    // inputs the user writes in place through inputView; their staging copy
+    // is skipped (unbound outputs skip their drain when they can be read in
+    // place through outputView instead)
+    std::vector<bool> inputDirect;
+
+    // outputs whose drain is deferred past retire(); pulled explicitly via
+    // drainOutputStream or outputView
+    std::vector<bool> outputDeferred;
+
+    // registered (persistent) inputs skip restaging into a slot that already
+    // holds their current contents; generations tick on register/markDirty
+    // and are recorded per slot when staged
+    std::vector<bool> inputRegistered;
+    std::vector<uint64_t> inputGeneration;
+    std::vector<std::vector<uint64_t>> slotStagedGeneration;
+
+    uint64_t stageNanos{ 0 };
+    uint64_t submitNanos{ 0 };
+
+    StagingPool *stagingPool{ nullptr };
+
 public:
-    SimpleRunner(Driver &driver, const IOP &iop, size_t programIndex = 0, size_t entrypointIndex = 0);
+    SimpleRunner(Driver &driver, const IOP &iop, size_t programIndex = 0, size_t entrypointIndex = 0,
+                 size_t ringDepth = 1);
     ~SimpleRunner();
 
     void addInputBuffer(uint8_t *buffer, size_t size, size_t index);
     void addOutputBuffer(uint8_t *buffer, size_t size, size_t index);
+
+    // Scatter-gather bindings: the tensor arrives (or leaves) as an ordered
+    // fragment list whose sizes sum to the host size, and staging reads from
+    // / drains into the fragments directly (see TensorLayout::fromHostGather
+    // / toHostScatter), so nobody coalesces into a contiguous scratch copy
+    // first.  A fragment binding replaces any contiguous binding for that
+    // tensor and vice versa.
+    void addInputFragments(const std::vector<BufferFragment> &fragments, size_t index);
+    void addOutputFragments(const std::vector<BufferFragment> &fragments, size_t index);
+
+    // Like addInputBuffer, but the binding is treated as persistent: once a
+    // ring slot holds the buffer's current contents, later invocations reuse
+    // the staged bytes instead of re-running fromHost.  Call markInputDirty
+    // after mutating the buffer so the next invoke restages it.  Weight- and
+    // KV-cache-style inputs that rarely change between calls skip their
+    // entire staging cost this way.
+    void registerInputBuffer(uint8_t *buffer, size_t size, size_t index);
+    void markInputDirty(size_t index);
+
+    // Allocate a host buffer for the given tensor on the device's NUMA node
+    // and bind it in one step, keeping staging copies and DMA node-local.
+    NumaBuffer allocateInputBuffer(size_t index, const Device &device);
+    NumaBuffer allocateOutputBuffer(size_t index, const Device &device);
+
+    struct View
+    {
+        uint8_t *data;
+        size_t size;
+    };
+
+    // Zero-copy access for tensors whose layout is one contiguous copy
+    // (CONTIGUOUS format): inputView exposes the tensor's region in the slot
+    // the next invokeAsync will use, so the caller writes it in place and the
+    // fromHost staging copy is skipped; outputView exposes a retired
+    // invocation's result in place, skipping the toHost copy.  Throws for
+    // strided tensors, which must keep using add*Buffer.  A view borrows its
+    // ring slot: it is invalidated as soon as a later submission claims that
+    // slot, so finish reading (or writing) before submitting ringDepth more
+    // invocations.
+    View inputView(size_t index);
+    View outputView(size_t index, const InvokeHandle &handle);
+
+    // Stream input `index` into the next slot's IOBuffer chunk by chunk (see
+    // TensorLayout::fromHostStream); the staging copy for it is skipped on
+    // the next submit.
+    void stageInputStream(size_t index, const TensorLayout::Reader &reader, size_t chunkSize = 1 << 20);
+
+    // Per-output completion semantics: eager outputs (the default) are
+    // toHost-transformed during retire(), so the caller is signaled as soon
+    // as the critical tensors are host-visible.  Outputs marked deferred are
+    // left in the IOBuffer at retire time -- debug taps and profiling
+    // tensors stop taxing the latency-critical path -- and are pulled on
+    // first access: in bulk into their bound buffer with
+    // drainDeferredOutput, streamed with drainOutputStream, or read in place
+    // with outputView.  All before the slot is resubmitted.
+    void deferOutput(size_t index, bool deferred = true);
+    void drainDeferredOutput(size_t index, const InvokeHandle &handle);
+    void drainOutputStream(size_t index, const TensorLayout::Writer &writer, const InvokeHandle &handle,
+                           size_t chunkSize = 1 << 20);
     void invoke(Device &device);
+    InvokeHandle invokeAsync(Device &device, std::function<void(Status)> callback = nullptr);
+    void invokeBatch(Device &device, const std::vector<RequestBuffers> &requests, size_t timeoutMs = 30000);
+
+    // noexcept invoke path for retry loops: a non-success status from
+    // groq_invoke (transient backpressure) or the completion wait comes back
+    // as a value with no exception, string building, or unwinding;
+    // GROQ_WRAPPER_ERROR stands for host-side staging/drain failures
+    Expected<InvokeHandle> tryInvokeAsync(Device &device) noexcept;
+    Status tryInvoke(Device &device, size_t timeoutMs = 30000) noexcept;
+
+    // Same, but the submission goes through the device's SubmissionQueue, so
+    // a High-priority (or tight-deadline) invocation bypasses queued Bulk
+    // work instead of waiting behind it.  Only the submit is queued; the
+    // completion wait stays with the caller.
+    InvokeHandle invokeAsync(SubmissionQueue &queue, SubmissionQueue::Priority priority,
+                             SubmissionQueue::Deadline deadline = SubmissionQueue::kNoDeadline,
+                             std::function<void(Status)> callback = nullptr);
+    void invoke(SubmissionQueue &queue, SubmissionQueue::Priority priority,
+                SubmissionQueue::Deadline deadline = SubmissionQueue::kNoDeadline);
+
+    size_t inFlightCount() const { return inFlight.load(); }
+    size_t depth() const { return ringDepth; }
+
+    const std::vector<TensorLayout> &getInputLayouts() const { return inputLayouts; }
+    const std::vector<TensorLayout> &getOutputLayouts() const { return outputLayouts; }
+
+    // duration of the last invokeAsync's staging and submit phases
+    uint64_t lastStageNanos() const { return stageNanos; }
+    uint64_t lastSubmitNanos() const { return submitNanos; }
+
+    // Distribute the per-tensor fromHost/toHost transforms of each invoke
+    // across the given pool (which may be shared by several runners); pass
+    // nullptr to go back to sequential staging.  The pool must outlive the
+    // runner's use of it.
+    void setStagingPool(StagingPool *pool) { stagingPool = pool; }
 
 private:
+    void stageInputs(size_t slot);
+    void captureOutputs(size_t slot);
+    void drainOutputs(size_t slot);
+
     const std::vector<TensorLayout> &inputTensorLayouts() const;
     const std::vector<TensorLayout> &outputTensorLayouts() const;
 };
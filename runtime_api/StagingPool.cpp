@@ -0,0 +1,119 @@
+#include "StagingPool.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <stdexcept>
+
+namespace groq {
+
+StagingPool::StagingPool(size_t numThreads)
+{
+    if (numThreads == 0) {
+        numThreads = 1;
+    }
+
+    workers.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; ++i) {
+        workers.emplace_back([this] { work(); });
+    }
+}
+
+StagingPool::~StagingPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+void StagingPool::work()
+{
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void StagingPool::parallelFor(size_t n, const std::function<void(size_t)> &body)
+{
+    if (n == 0) {
+        return;
+    }
+    if (n == 1) {
+        body(0);
+        return;
+    }
+
+    std::atomic<size_t> nextIndex{ 0 };
+    std::atomic<size_t> liveTasks{ 0 };
+    std::exception_ptr firstError;
+    std::mutex errorLock;
+    std::condition_variable finished;
+    std::mutex finishedLock;
+
+    // Every task drains indices from the shared counter, so however the
+    // scheduler interleaves them, all n iterations run exactly once.
+    const auto runTask = [&] {
+        for (;;) {
+            const size_t index = nextIndex.fetch_add(1);
+            if (index >= n) {
+                break;
+            }
+            try {
+                body(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(errorLock);
+                if (!firstError) {
+                    firstError = std::current_exception();
+                }
+            }
+        }
+    };
+
+    const size_t helpers = workers.size() < n - 1 ? workers.size() : n - 1;
+    liveTasks.store(helpers);
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        for (size_t i = 0; i < helpers; ++i) {
+            tasks.emplace_back([&] {
+                runTask();
+                // the decrement must happen under finishedLock: it is what
+                // lets the caller destroy these stack-captured locals, so
+                // publishing it outside the lock would race the caller's
+                // return against this task's notify
+                std::lock_guard<std::mutex> doneGuard(finishedLock);
+                if (liveTasks.fetch_sub(1) == 1) {
+                    finished.notify_all();
+                }
+            });
+        }
+    }
+    wake.notify_all();
+
+    // the calling thread helps rather than blocking idle
+    runTask();
+
+    std::unique_lock<std::mutex> guard(finishedLock);
+    finished.wait(guard, [&] { return liveTasks.load() == 0; });
+
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+}
+
+} // namespace groq
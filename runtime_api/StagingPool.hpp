@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace groq {
+
+/**
+ * @brief groq::StagingPool runs per-tensor layout transforms in parallel
+ *
+ * Entrypoints with dozens of tensors stage one tensor at a time on one core
+ * while the rest of the host idles.  A StagingPool is a small worker pool a
+ * runner (or several runners -- the pool is safe to share) can be pointed at
+ * with SimpleRunner::setStagingPool, after which the per-tensor
+ * fromHost/toHost transforms of each invoke are distributed across the
+ * workers.  Tensors write disjoint regions of the slot's IOBuffer, so the
+ * transforms are independent.
+ */
+class StagingPool
+{
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex lock;
+    std::condition_variable wake;
+    bool stopping{ false };
+
+    void work();
+
+public:
+    explicit StagingPool(size_t numThreads = std::thread::hardware_concurrency());
+    ~StagingPool();
+
+    StagingPool(const StagingPool &) = delete;
+    StagingPool &operator=(const StagingPool &) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    // Run body(0) .. body(n-1) across the workers and the calling thread;
+    // returns when all have finished.  The first exception thrown by any
+    // iteration is rethrown in the caller.
+    void parallelFor(size_t n, const std::function<void(size_t)> &body);
+};
+
+} // namespace groq
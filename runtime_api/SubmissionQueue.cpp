@@ -0,0 +1,73 @@
+#include "SubmissionQueue.hpp"
+
+#include "Device.hpp"
+
+#include <memory>
+#include <stdexcept>
+
+namespace groq {
+
+SubmissionQueue::SubmissionQueue(Device &device)
+    : target(device)
+    , worker([this] { work(); })
+{
+}
+
+SubmissionQueue::~SubmissionQueue()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+void SubmissionQueue::work()
+{
+    for (;;) {
+        Task *task = nullptr;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return; // stopping, and nothing left to run
+            }
+            task = tasks.top();
+            tasks.pop();
+        }
+
+        try {
+            task->submit();
+            task->done.set_value();
+        } catch (...) {
+            task->done.set_exception(std::current_exception());
+        }
+    }
+}
+
+void SubmissionQueue::run(std::function<void()> submit, Priority priority, Deadline deadline)
+{
+    // run() blocks until the task has executed, so the Task can live on this
+    // frame's stack
+    Task task;
+    task.priority = priority;
+    task.deadline = deadline;
+    task.submit = std::move(submit);
+
+    std::future<void> done = task.done.get_future();
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (stopping) {
+            throw std::runtime_error("Submission queue is shutting down");
+        }
+        task.sequence = nextSequence++;
+        tasks.push(&task);
+    }
+    wake.notify_all();
+
+    done.get();
+}
+
+} // namespace groq
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace groq {
+
+class Device;
+
+/**
+ * @brief groq::SubmissionQueue orders groq_invoke submissions onto one device
+ *
+ * Interleaved submissions from several runners otherwise reach the device
+ * first-come-first-served, so queued bulk work inflates interactive P99.
+ * The queue runs submissions on its own thread ordered by priority class,
+ * then earliest deadline, then arrival: a High submission enqueued behind
+ * twenty Bulk ones runs next.  Only the submit step is serialized --
+ * completion waits stay on the callers' threads, so the device pipeline
+ * stays full.
+ *
+ * Route invocations through it with SimpleRunner::invoke(queue, priority).
+ */
+class SubmissionQueue
+{
+public:
+    enum class Priority : uint8_t { High = 0, Normal = 1, Bulk = 2 };
+
+    using Deadline = std::chrono::steady_clock::time_point;
+    static constexpr Deadline kNoDeadline = Deadline::max();
+
+private:
+    struct Task
+    {
+        Priority priority;
+        Deadline deadline;
+        uint64_t sequence;
+        std::function<void()> submit;
+        std::promise<void> done;
+    };
+
+    struct TaskOrder
+    {
+        // priority_queue surfaces the *largest*, so "runs first" must
+        // compare as greater: lower priority value, then earlier deadline,
+        // then earlier arrival
+        bool operator()(const Task *a, const Task *b) const
+        {
+            if (a->priority != b->priority) {
+                return a->priority > b->priority;
+            }
+            if (a->deadline != b->deadline) {
+                return a->deadline > b->deadline;
+            }
+            return a->sequence > b->sequence;
+        }
+    };
+
+    Device &target;
+    std::priority_queue<Task *, std::vector<Task *>, TaskOrder> tasks;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::thread worker;
+    uint64_t nextSequence{ 0 };
+    bool stopping{ false };
+
+    void work();
+
+public:
+    explicit SubmissionQueue(Device &device);
+    ~SubmissionQueue();
+
+    SubmissionQueue(const SubmissionQueue &) = delete;
+    SubmissionQueue &operator=(const SubmissionQueue &) = delete;
+
+    Device &device() { return target; }
+
+    // Run `submit` on the submission thread once it reaches the front of the
+    // queue; blocks the caller until it has run (exceptions propagate back).
+    void run(std::function<void()> submit, Priority priority, Deadline deadline = kNoDeadline);
+};
+
+} // namespace groq
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace groq {
+
+/**
+ * @brief Lightweight phase tracing for the invoke hot path
+ *
+ * When the build defines GROQ_RUNTIME_TRACE (cmake -DGROQ_RUNTIME_TRACE=ON),
+ * the runner drops a TraceRecord into a fixed-size lock-free ring at each
+ * phase boundary: staging begin/end, submit, device completion, drain
+ * begin/end.  Records carry nanosecond steady-clock timestamps plus the
+ * program/entrypoint/slot they belong to, so a P99 spike can be attributed to
+ * host staging versus device queueing from a production process, without an
+ * external profiler.  Drain the ring periodically with TraceBuffer::snapshot.
+ *
+ * Without the define, GROQ_TRACE expands to nothing and no tracing code is
+ * compiled at all.
+ */
+enum class TracePhase : uint8_t {
+    StageBegin = 0,
+    StageEnd,
+    Submit,
+    Completion,
+    DrainBegin,
+    DrainEnd,
+};
+
+struct TraceRecord
+{
+    uint64_t nanos; // steady_clock, since an arbitrary epoch; deltas are what matter
+    uint64_t sequence;
+    uint32_t slot;
+    uint16_t programIndex;
+    uint16_t entrypointIndex;
+    TracePhase phase;
+};
+
+#ifdef GROQ_RUNTIME_TRACE
+
+class TraceBuffer
+{
+    static constexpr size_t kCapacity = 1 << 16;
+
+    std::vector<TraceRecord> records{ kCapacity };
+    std::atomic<uint64_t> next{ 0 };
+
+public:
+    static TraceBuffer &instance()
+    {
+        static TraceBuffer buffer;
+        return buffer;
+    }
+
+    void record(TracePhase phase, size_t programIndex, size_t entrypointIndex, size_t slot)
+    {
+        const uint64_t sequence = next.fetch_add(1, std::memory_order_relaxed);
+        TraceRecord &slotRecord = records[sequence % kCapacity];
+        slotRecord.nanos = std::chrono::steady_clock::now().time_since_epoch().count();
+        slotRecord.sequence = sequence;
+        slotRecord.slot = static_cast<uint32_t>(slot);
+        slotRecord.programIndex = static_cast<uint16_t>(programIndex);
+        slotRecord.entrypointIndex = static_cast<uint16_t>(entrypointIndex);
+        slotRecord.phase = phase;
+    }
+
+    // Copy out the retained records, oldest first.  Records being written
+    // concurrently with the copy may be torn; consumers should drop records
+    // whose sequence is out of order.
+    std::vector<TraceRecord> snapshot() const
+    {
+        const uint64_t end = next.load(std::memory_order_relaxed);
+        const uint64_t count = end < kCapacity ? end : kCapacity;
+        const uint64_t begin = end - count;
+
+        std::vector<TraceRecord> out;
+        out.reserve(count);
+        for (uint64_t sequence = begin; sequence < end; ++sequence) {
+            out.push_back(records[sequence % kCapacity]);
+        }
+        return out;
+    }
+};
+
+#define GROQ_TRACE(phase, programIndex, entrypointIndex, slot)                                                         \
+    groq::TraceBuffer::instance().record(groq::TracePhase::phase, programIndex, entrypointIndex, slot)
+
+#else
+
+#define GROQ_TRACE(phase, programIndex, entrypointIndex, slot) ((void)0)
+
+#endif // GROQ_RUNTIME_TRACE
+
+} // namespace groq
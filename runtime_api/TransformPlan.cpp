@@ -0,0 +1,247 @@
+#include "TransformPlan.hpp"
+
+#include "Misc.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <random>
+
+namespace groq {
+
+namespace {
+
+// Sentinels in the per-byte source map built by the probe passes.
+constexpr uint32_t kUntouched = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t kConstant = std::numeric_limits<uint32_t>::max() - 1;
+
+Status runLibrary(::TensorLayout layout, TransformPlan::Direction direction, uint8_t *input, size_t inputSize,
+                  uint8_t *output, size_t outputSize)
+{
+    if (direction == TransformPlan::Direction::FromHost) {
+        return groq_tensor_layout_from_host(layout, input, inputSize, output, outputSize);
+    }
+    return groq_tensor_layout_to_host(layout, input, inputSize, output, outputSize);
+}
+
+} // namespace
+
+TransformPlan TransformPlan::compile(::TensorLayout layout, Direction direction, size_t inputSize, size_t outputSize)
+{
+    TransformPlan plan;
+    plan.inputSize = inputSize;
+    plan.outputSize = outputSize;
+
+    // Offsets are stored as uint32_t; huge tensors keep the library path.
+    if (inputSize >= kConstant || outputSize >= kConstant || inputSize == 0 || outputSize == 0) {
+        return plan;
+    }
+
+    std::vector<uint8_t> input(inputSize, 0x00);
+    std::vector<uint8_t> output(outputSize, 0x00);
+
+    // One probe pass: fill the input with the given byte of each offset
+    // (optionally complemented), prefill the output, run the library
+    // transform, and hand the output to the caller.
+    const auto probe = [&](unsigned offsetByte, bool complement, uint8_t prefill) -> const std::vector<uint8_t> & {
+        for (size_t i = 0; i < inputSize; ++i) {
+            const uint8_t value = static_cast<uint8_t>(i >> (8 * offsetByte));
+            input[i] = complement ? static_cast<uint8_t>(~value) : value;
+        }
+        std::memset(&output[0], prefill, outputSize);
+        GROQOK(runLibrary(layout, direction, &input[0], inputSize, &output[0], outputSize));
+        return output;
+    };
+
+    // Classify every output byte as mapped / constant / untouched.  A mapped
+    // byte flips when the input is complemented (x != ~x for every x); an
+    // untouched byte keeps the prefill across both prefill pairs -- two pairs
+    // because a mapped byte can mimic one pair by coincidence, but no source
+    // byte equals both 0x55 and 0x33.
+    std::vector<uint32_t> sourceMap(outputSize, kUntouched);
+    std::vector<uint8_t> constants(outputSize, 0x00);
+
+    {
+        std::vector<uint8_t> passA1 = probe(0, false, 0x55);
+        std::vector<uint8_t> passB1 = probe(0, true, 0xAA);
+        std::vector<uint8_t> passA2 = probe(0, false, 0x33);
+        const std::vector<uint8_t> &passB2 = probe(0, true, 0xCC);
+
+        for (size_t i = 0; i < outputSize; ++i) {
+            if (passA1[i] == 0x55 && passB1[i] == 0xAA && passA2[i] == 0x33 && passB2[i] == 0xCC) {
+                continue; // untouched (a neighbor layout's region, or unwritten padding)
+            }
+            if (passA1[i] == passB1[i]) {
+                sourceMap[i] = kConstant;
+                constants[i] = passA1[i];
+            } else {
+                sourceMap[i] = passA1[i]; // low offset byte; upper bytes follow
+            }
+        }
+    }
+
+    for (unsigned offsetByte = 1; offsetByte < sizeof(uint32_t); ++offsetByte) {
+        if (inputSize <= (size_t(1) << (8 * offsetByte))) {
+            break; // all upper offset bytes are zero
+        }
+        const std::vector<uint8_t> &pass = probe(offsetByte, false, 0x00);
+        for (size_t i = 0; i < outputSize; ++i) {
+            if (sourceMap[i] < kConstant) {
+                sourceMap[i] |= uint32_t(pass[i]) << (8 * offsetByte);
+            }
+        }
+    }
+
+    // Compress the byte map into contiguous copy and fill runs.
+    for (size_t i = 0; i < outputSize;) {
+        if (sourceMap[i] == kUntouched) {
+            ++i;
+        } else if (sourceMap[i] == kConstant) {
+            size_t end = i + 1;
+            while (end < outputSize && sourceMap[end] == kConstant && constants[end] == constants[i]) {
+                ++end;
+            }
+            plan.fillRuns.push_back({ uint32_t(i), uint32_t(end - i), constants[i] });
+            i = end;
+        } else {
+            size_t end = i + 1;
+            while (end < outputSize && sourceMap[end] == sourceMap[i] + (end - i)) {
+                ++end;
+            }
+            plan.copyRuns.push_back({ uint32_t(i), sourceMap[i], uint32_t(end - i) });
+            i = end;
+        }
+    }
+
+    // Validate: a random vector must transform identically through the
+    // library and the plan, or the layout is not a byte permutation and the
+    // plan must not be used.
+    plan.isValid = true; // provisionally, so validate() can execute it
+    plan.isValid = plan.validate(layout, direction);
+
+    if (!plan.isValid) {
+        plan.copyRuns.clear();
+        plan.fillRuns.clear();
+    }
+
+    return plan;
+}
+
+bool TransformPlan::validate(::TensorLayout layout, Direction direction) const
+{
+    if (!isValid) {
+        return false;
+    }
+
+    std::vector<uint8_t> input(inputSize);
+    std::mt19937 eng(0x67726f71); // fixed seed: validation must be deterministic
+    for (size_t i = 0; i < inputSize; ++i) {
+        input[i] = static_cast<uint8_t>(eng());
+    }
+
+    std::vector<uint8_t> expected(outputSize, 0x00);
+    GROQOK(runLibrary(layout, direction, &input[0], inputSize, &expected[0], outputSize));
+
+    std::vector<uint8_t> planned(outputSize, 0x00);
+    execute(&input[0], &planned[0]);
+
+    return std::memcmp(&expected[0], &planned[0], outputSize) == 0;
+}
+
+TransformPlan TransformPlan::fromRuns(size_t inputSize, size_t outputSize, std::vector<CopyRun> copyRuns,
+                                      std::vector<FillRun> fillRuns)
+{
+    TransformPlan plan;
+    plan.inputSize = inputSize;
+    plan.outputSize = outputSize;
+    plan.copyRuns = std::move(copyRuns);
+    plan.fillRuns = std::move(fillRuns);
+
+    // sanity-check the runs against the buffer bounds before trusting them
+    plan.isValid = true;
+    for (const auto &run : plan.copyRuns) {
+        if (size_t(run.dst) + run.len > outputSize || size_t(run.src) + run.len > inputSize) {
+            plan.isValid = false;
+        }
+    }
+    for (const auto &run : plan.fillRuns) {
+        if (size_t(run.dst) + run.len > outputSize) {
+            plan.isValid = false;
+        }
+    }
+
+    return plan;
+}
+
+void TransformPlan::executeInputWindow(const uint8_t *windowData, size_t windowOffset, size_t windowLen,
+                                       uint8_t *output) const
+{
+    assert(isValid);
+    assert(windowData);
+    assert(output);
+
+    const size_t windowEnd = windowOffset + windowLen;
+
+    for (const auto &run : copyRuns) {
+        const size_t srcBegin = run.src > windowOffset ? run.src : windowOffset;
+        const size_t srcEnd = run.src + run.len < windowEnd ? run.src + run.len : windowEnd;
+        if (srcBegin >= srcEnd) {
+            continue;
+        }
+        std::memcpy(output + run.dst + (srcBegin - run.src), windowData + (srcBegin - windowOffset),
+                    srcEnd - srcBegin);
+    }
+
+    if (windowOffset == 0) {
+        for (const auto &run : fillRuns) {
+            std::memset(output + run.dst, run.value, run.len);
+        }
+    }
+}
+
+void TransformPlan::executeOutputWindow(const uint8_t *input, uint8_t *windowData, size_t windowOffset,
+                                        size_t windowLen) const
+{
+    assert(isValid);
+    assert(input);
+    assert(windowData);
+
+    std::memset(windowData, 0x00, windowLen);
+
+    const size_t windowEnd = windowOffset + windowLen;
+
+    for (const auto &run : copyRuns) {
+        const size_t dstBegin = run.dst > windowOffset ? run.dst : windowOffset;
+        const size_t dstEnd = run.dst + run.len < windowEnd ? run.dst + run.len : windowEnd;
+        if (dstBegin >= dstEnd) {
+            continue;
+        }
+        std::memcpy(windowData + (dstBegin - windowOffset), input + run.src + (dstBegin - run.dst),
+                    dstEnd - dstBegin);
+    }
+
+    for (const auto &run : fillRuns) {
+        const size_t dstBegin = run.dst > windowOffset ? run.dst : windowOffset;
+        const size_t dstEnd = run.dst + run.len < windowEnd ? run.dst + run.len : windowEnd;
+        if (dstBegin >= dstEnd) {
+            continue;
+        }
+        std::memset(windowData + (dstBegin - windowOffset), run.value, dstEnd - dstBegin);
+    }
+}
+
+void TransformPlan::execute(const uint8_t *input, uint8_t *output) const
+{
+    assert(isValid);
+    assert(input);
+    assert(output);
+
+    for (const auto &run : copyRuns) {
+        std::memcpy(output + run.dst, input + run.src, run.len);
+    }
+    for (const auto &run : fillRuns) {
+        std::memset(output + run.dst, run.value, run.len);
+    }
+}
+
+} // namespace groq
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <groqio.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace groq {
+
+/**
+ * @brief groq::TransformPlan is a precompiled host<->TSP layout transform
+ *
+ * groq_tensor_layout_from_host / _to_host re-derive the layout's scatter
+ * pattern on every call, which for STRIDED layouts is a scalar byte walk that
+ * dominates host-side time.  The pattern itself is fixed per layout, so the
+ * plan recovers it once by pushing probe vectors through the library call and
+ * recording, for every output byte, which input byte it came from (or which
+ * constant the library wrote, e.g. padding).  The byte map is then compressed
+ * into runs of contiguous copies and fills, and executing the plan is a short
+ * loop of memcpy/memset over those runs -- wide vector moves on every ISA.
+ *
+ * Compilation ends with a validation pass: a random vector is pushed through
+ * both the library and the plan, and on any mismatch (a layout whose transform
+ * is not a plain byte permutation) the plan is discarded and callers keep
+ * using the library call.  A plan is therefore never less correct than the
+ * library, only faster.
+ */
+class TransformPlan
+{
+public:
+    enum class Direction { FromHost, ToHost };
+
+    struct CopyRun
+    {
+        uint32_t dst;
+        uint32_t src;
+        uint32_t len;
+    };
+
+    struct FillRun
+    {
+        uint32_t dst;
+        uint32_t len;
+        uint8_t value;
+    };
+
+    static TransformPlan compile(::TensorLayout layout, Direction direction, size_t inputSize, size_t outputSize);
+
+    // Rebuild a previously compiled (and validated) plan from its run
+    // tables, e.g. out of a PlanCache file.
+    static TransformPlan fromRuns(size_t inputSize, size_t outputSize, std::vector<CopyRun> copyRuns,
+                                  std::vector<FillRun> fillRuns);
+
+    // One random-vector comparison against the library transform -- the same
+    // check compile() ends with.  Used to re-validate plans loaded from a
+    // cache before they are trusted for a particular layout.
+    bool validate(::TensorLayout layout, Direction direction) const;
+
+    bool valid() const { return isValid; }
+    size_t inputBytes() const { return inputSize; }
+    size_t outputBytes() const { return outputSize; }
+    size_t numCopyRuns() const { return copyRuns.size(); }
+    const std::vector<CopyRun> &copies() const { return copyRuns; }
+    const std::vector<FillRun> &fills() const { return fillRuns; }
+    void execute(const uint8_t *input, uint8_t *output) const;
+
+    // Streaming building blocks: apply only the part of the plan that
+    // touches a window of the input or output space, so a transform can run
+    // incrementally over chunks instead of needing both tensors whole.
+
+    // Scatter input bytes [windowOffset, windowOffset+windowLen), available
+    // at windowData, into the full-size output; fill runs are applied on the
+    // first window (windowOffset == 0).
+    void executeInputWindow(const uint8_t *windowData, size_t windowOffset, size_t windowLen, uint8_t *output) const;
+
+    // Gather output bytes [windowOffset, windowOffset+windowLen) from the
+    // full-size input into windowData; bytes the plan does not produce are
+    // zeroed.
+    void executeOutputWindow(const uint8_t *input, uint8_t *windowData, size_t windowOffset, size_t windowLen) const;
+
+private:
+    bool isValid{ false };
+    size_t inputSize{ 0 };
+    size_t outputSize{ 0 };
+    std::vector<CopyRun> copyRuns;
+    std::vector<FillRun> fillRuns;
+};
+
+} // namespace groq
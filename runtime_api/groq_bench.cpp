@@ -0,0 +1,261 @@
+/**
+ * groq_bench: latency/throughput benchmark for the SimpleRunner invoke path.
+ *
+ * Takes any IOP file, binds randomly-filled host buffers for program 0 /
+ * entrypoint 0, warms up, then measures N iterations with a per-phase
+ * breakdown (fromHost staging, groq_invoke submit, device completion wait,
+ * toHost drain), reporting p50/p95/p99 latency and sustained invocations/sec.
+ *
+ * Usage:
+ *   groq_bench <file.iop> [--iterations N] [--warmup N] [--ring-depth N]
+ *              [--csv <file>] [--json <file>]
+ */
+
+#include "Device.hpp"
+#include "Driver.hpp"
+#include "IOP.hpp"
+#include "Misc.hpp"
+#include "SimpleRunner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Sample
+{
+    uint64_t stage;  // ns
+    uint64_t submit; // ns
+    uint64_t wait;   // ns
+    uint64_t drain;  // ns
+
+    uint64_t total() const { return stage + submit + wait + drain; }
+};
+
+uint64_t percentile(std::vector<uint64_t> sorted, double p)
+{
+    const size_t index = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted.at(index);
+}
+
+std::vector<uint64_t> sortedTotals(const std::vector<Sample> &samples)
+{
+    std::vector<uint64_t> totals;
+    totals.reserve(samples.size());
+    for (const auto &sample : samples) {
+        totals.push_back(sample.total());
+    }
+    std::sort(totals.begin(), totals.end());
+    return totals;
+}
+
+void writeCsv(const std::string &filename, const std::vector<Sample> &samples)
+{
+    std::ofstream out(filename);
+    out << "iteration,stage_ns,submit_ns,wait_ns,drain_ns,total_ns\n";
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const auto &s = samples.at(i);
+        out << i << "," << s.stage << "," << s.submit << "," << s.wait << "," << s.drain << "," << s.total() << "\n";
+    }
+}
+
+void writeJson(const std::string &filename, const std::vector<Sample> &samples, double invokesPerSec)
+{
+    const auto totals = sortedTotals(samples);
+
+    std::ofstream out(filename);
+    out << "{\n";
+    out << "  \"iterations\": " << samples.size() << ",\n";
+    out << "  \"invokes_per_sec\": " << invokesPerSec << ",\n";
+    out << "  \"p50_ns\": " << percentile(totals, 0.50) << ",\n";
+    out << "  \"p95_ns\": " << percentile(totals, 0.95) << ",\n";
+    out << "  \"p99_ns\": " << percentile(totals, 0.99) << ",\n";
+    out << "  \"samples\": [\n";
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const auto &s = samples.at(i);
+        out << "    {\"stage_ns\": " << s.stage << ", \"submit_ns\": " << s.submit << ", \"wait_ns\": " << s.wait
+            << ", \"drain_ns\": " << s.drain << "}" << (i + 1 < samples.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+void usage(const char *argv0)
+{
+    std::cout << "Usage\n"
+              << argv0
+              << " </path/to/file.iop> [--iterations N] [--warmup N] [--ring-depth N]"
+                 " [--csv <file>] [--json <file>]"
+              << std::endl;
+    std::exit(1);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::string iopFile;
+    std::string csvFile;
+    std::string jsonFile;
+    size_t iterations = 1000;
+    size_t warmup = 50;
+    size_t ringDepth = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                usage(argv[0]);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--iterations") {
+            iterations = std::stoul(value());
+        } else if (arg == "--warmup") {
+            warmup = std::stoul(value());
+        } else if (arg == "--ring-depth") {
+            ringDepth = std::stoul(value());
+        } else if (arg == "--csv") {
+            csvFile = value();
+        } else if (arg == "--json") {
+            jsonFile = value();
+        } else if (iopFile.empty()) {
+            iopFile = arg;
+        } else {
+            usage(argv[0]);
+        }
+    }
+
+    if (iopFile.empty() || iterations == 0) {
+        usage(argv[0]);
+    }
+
+    // Access GroqCard
+    groq::Driver driver;
+    groq::Device device = driver.getNextDevice();
+    device.open();
+    device.reset();
+    device.clearMemory();
+
+    // Load IOP file data
+    const groq::IOP iop = groq::IOP::fromFile(iopFile);
+    device.loadProgram(iop, 0, false);
+
+    groq::SimpleRunner runner(driver, iop, 0, 0, ringDepth);
+
+    // Bind randomly-filled inputs and zeroed outputs for entrypoint 0
+    const auto &program = iop.getPrograms().at(0);
+    const auto &ep = program.getEntrypoints().at(0);
+    const auto &inputLayouts = ep.getInputIODescriptor().getTensorLayouts();
+    const auto &outputLayouts = ep.getOutputIODescriptor().getTensorLayouts();
+
+    std::mt19937 eng(std::random_device{}());
+    std::vector<std::vector<uint8_t>> inputs;
+    std::vector<std::vector<uint8_t>> outputs;
+
+    for (size_t i = 0; i < inputLayouts.size(); ++i) {
+        inputs.emplace_back(inputLayouts.at(i).getHostSize());
+        std::generate(inputs.back().begin(), inputs.back().end(), [&] { return static_cast<uint8_t>(eng()); });
+        runner.addInputBuffer(&inputs.back()[0], inputs.back().size(), i);
+    }
+    for (size_t i = 0; i < outputLayouts.size(); ++i) {
+        outputs.emplace_back(outputLayouts.at(i).getHostSize(), 0x00);
+        runner.addOutputBuffer(&outputs.back()[0], outputs.back().size(), i);
+    }
+
+    for (size_t i = 0; i < warmup; ++i) {
+        runner.invoke(device);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    const auto nanosSince = [](Clock::time_point start) {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    };
+
+    std::vector<Sample> samples;
+    samples.reserve(iterations);
+
+    // Keep up to ringDepth invocations in flight so --ring-depth measures
+    // sustained pipelined throughput; depth 1 reproduces the serialized
+    // latency measurement.  Handles retire oldest-first (the ring's
+    // rotation order), and at depth > 1 the "wait" phase overlaps staging
+    // of later iterations -- read it as time-to-completion under load, not
+    // pure device time.
+    struct Pending
+    {
+        Sample sample;
+        groq::InvokeHandle handle;
+    };
+    std::deque<Pending> inflight;
+
+    const auto retireOldest = [&] {
+        Pending pending = std::move(inflight.front());
+        inflight.pop_front();
+
+        const auto waitStart = Clock::now();
+        pending.handle.waitCompletion();
+        pending.sample.wait = nanosSince(waitStart);
+
+        const auto drainStart = Clock::now();
+        pending.handle.retire();
+        pending.sample.drain = nanosSince(drainStart);
+
+        samples.push_back(pending.sample);
+    };
+
+    const auto runStart = Clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        if (inflight.size() == ringDepth) {
+            retireOldest();
+        }
+
+        Pending pending;
+        pending.handle = runner.invokeAsync(device);
+        pending.sample.stage = runner.lastStageNanos();
+        pending.sample.submit = runner.lastSubmitNanos();
+        inflight.push_back(std::move(pending));
+    }
+    while (!inflight.empty()) {
+        retireOldest();
+    }
+    const double elapsedSec = nanosSince(runStart) / 1e9;
+    const double invokesPerSec = iterations / elapsedSec;
+
+    const auto totals = sortedTotals(samples);
+    const auto meanOf = [&](uint64_t Sample::*phase) {
+        uint64_t sum = 0;
+        for (const auto &sample : samples) {
+            sum += sample.*phase;
+        }
+        return sum / samples.size();
+    };
+
+    std::cout << "iterations:      " << iterations << " (after " << warmup << " warmup)\n"
+              << "ring depth:      " << ringDepth << "\n"
+              << "invokes/sec:     " << invokesPerSec << "\n"
+              << "latency p50:     " << percentile(totals, 0.50) << " ns\n"
+              << "latency p95:     " << percentile(totals, 0.95) << " ns\n"
+              << "latency p99:     " << percentile(totals, 0.99) << " ns\n"
+              << "mean stage:      " << meanOf(&Sample::stage) << " ns\n"
+              << "mean submit:     " << meanOf(&Sample::submit) << " ns\n"
+              << "mean wait:       " << meanOf(&Sample::wait) << " ns\n"
+              << "mean drain:      " << meanOf(&Sample::drain) << " ns" << std::endl;
+
+    if (!csvFile.empty()) {
+        writeCsv(csvFile, samples);
+    }
+    if (!jsonFile.empty()) {
+        writeJson(jsonFile, samples, invokesPerSec);
+    }
+
+    return 0;
+}